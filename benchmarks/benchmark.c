@@ -5,7 +5,7 @@ Creator: Claudio Raimondi
 Email: claudio.raimondi@pm.me                                                   
 
 created at: 2025-02-14 17:53:51                                                 
-last edited: 2025-03-05 14:58:30                                                
+last edited: 2026-10-17 08:27:14                                                
 
 ================================================================================*/
 
@@ -18,6 +18,7 @@ last edited: 2025-03-05 14:58:30
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <time.h>
 
 #define MAX_FIELDS 64
 #define N_ITERATIONS 1'000'000
@@ -30,6 +31,8 @@ last edited: 2025-03-05 14:58:30
 #define static_assert _Static_assert
 #define STR_LEN(str) sizeof(str) - 1
 #define ALIGNED(n) __attribute__((aligned(n)))
+#define REPLAY_SIZE (256 * 1024 * 1024)
+#define REPLAY_RUNS 5
 
 static void init_random_tags(char **tags);
 static void init_random_values(char **values);
@@ -38,11 +41,16 @@ static void fill_message_buffers(char **buffers, char **tags, char **values);
 static void fill_message_lengths(uint16_t *message_lengths, char **message_buffers);
 static void serialize(fix_message_t *messages);
 static void serialize_raw(fix_message_t *messages);
+static void serialize_reserved(fix_message_t *messages);
 static void deserialize(char **buffers);
+static void deserialize_passes(char **buffers);
+static void deserialize_const(char **buffers);
+static void replay(char **buffers);
+static void discard_message(const fix_message_t *message, const char *raw, const uint16_t len, const uint16_t thread, void *context);
 static char *generate_random_string(const char *charset, const uint8_t charset_len, const uint16_t median_len, const uint16_t max_len);
 static double gaussian_rand(const double mean, const double stddev);
 static inline uint16_t clamp(const uint16_t n, const uint16_t min, const uint16_t max);
-static uint8_t compute_checksum(const char *buffer, const uint16_t len);
+static uint8_t reference_checksum(const char *buffer, const uint16_t len);
 static uint32_t open_p(const char *pathname, const int32_t flags, const mode_t mode);
 static void *calloc_p(const size_t n, const size_t size);
 static void free_strings(char **strings, const uint16_t n);
@@ -52,6 +60,8 @@ int32_t main(void)
 {
   static_assert(BUFFER_SIZE < UINT16_MAX, "BUFFER_SIZE must be less than UINT16_MAX");
 
+  printf("kernel tier: %s\n", ff_isa());
+
   char **tags = calloc_p(MAX_FIELDS, sizeof(char *));
   char **values = calloc_p(MAX_FIELDS, sizeof(char *));
 
@@ -65,6 +75,7 @@ int32_t main(void)
     
     serialize(message_structs);
     serialize_raw(message_structs);
+    serialize_reserved(message_structs);
     
     free_message_structs(message_structs);
     free(message_structs);
@@ -78,6 +89,9 @@ int32_t main(void)
     fill_message_lengths(message_lengths, message_buffers);
     
     deserialize(message_buffers);
+    deserialize_passes(message_buffers);
+    deserialize_const(message_buffers);
+    replay(message_buffers);
     free_strings(message_buffers, MAX_FIELDS);
     free(message_buffers);
     free(message_lengths);
@@ -146,7 +160,7 @@ static void fill_message_buffers(char **buffers, char **tags, char **values)
     memcpy(buffer + total, temp_body, body_len);
     total += body_len;
 
-    uint8_t checksum = compute_checksum(buffer, total);
+    uint8_t checksum = reference_checksum(buffer, total);
 
     total += sprintf(buffer + total, "10=%03d\x01", checksum);
   }
@@ -220,6 +234,39 @@ static void serialize_raw(fix_message_t *messages)
   close(fd);
 }
 
+//same output as ff_serialize, without the pass over the fields to compute BodyLength
+static void serialize_reserved(fix_message_t *messages)
+{
+  const int32_t fd = open_p("benchmark_serialize_reserved.csv", O_TRUNC | O_CREAT | O_WRONLY, 0644);
+  
+  uint64_t start, end;
+  uint32_t aux;
+  uint16_t len;
+
+  char buffer[BUFFER_SIZE] ALIGNED(ALIGNMENT) = {0};
+
+  dprintf(fd, "# of fields, # of cpu cycles\n");
+  for (uint16_t i = 0; i < MAX_FIELDS; i++)
+  {
+    fix_message_t message = messages[i];
+    uint64_t total_cycles = 0;
+    
+    for (uint32_t j = 0; j < N_ITERATIONS; j++)
+    {      
+      start = __rdtscp(&aux);
+      ff_serialize_reserved(buffer, &message, &len);
+      end = __rdtscp(&aux);
+    
+      total_cycles += (end - start);
+    }
+  
+    const uint64_t avg_cpu_cycles = total_cycles / N_ITERATIONS;
+    dprintf(fd, "%d, %lu\n", i + 1, avg_cpu_cycles);
+  }
+
+  close(fd);
+}
+
 static void deserialize(char **buffers)
 {
   const int32_t fd = open_p("benchmark_deserialize.csv", O_TRUNC | O_CREAT | O_WRONLY, 0644);
@@ -240,6 +287,7 @@ static void deserialize(char **buffers)
     for (uint32_t j = 0; j < N_ITERATIONS; j++)
     {
       memcpy(buffer, buffers[i], BUFFER_SIZE);
+      message.field_count = MAX_FIELDS;
 
       start = __rdtscp(&aux);
       ff_deserialize(buffer, BUFFER_SIZE, &message);
@@ -256,6 +304,172 @@ static void deserialize(char **buffers)
   close(fd);
 }
 
+//ff_deserialize reads each block once, ff_deserialize_batch still checksums and tokenizes in two separate passes
+static void deserialize_passes(char **buffers)
+{
+  const int32_t fd = open_p("benchmark_deserialize_passes.csv", O_TRUNC | O_CREAT | O_WRONLY, 0644);
+  
+  uint64_t start, end;
+  uint32_t aux;
+  
+  fix_message_t message ALIGNED(ALIGNMENT) = {0};
+  message.fields = calloc_p(MAX_FIELDS, sizeof(fix_field_t));
+  
+  dprintf(fd, "# of fields, # of cpu cycles (single pass), # of cpu cycles (separate passes)\n");
+  for (uint16_t i = 0; i < MAX_FIELDS; i++)
+  {
+    char buffer[BUFFER_SIZE] ALIGNED(ALIGNMENT);
+    char *const batch_buffers[1] = { buffer };
+    const uint16_t batch_sizes[1] = { BUFFER_SIZE };
+    uint16_t batch_lengths[1];
+    uint64_t fused_cycles = 0;
+    uint64_t separate_cycles = 0;
+    
+    for (uint32_t j = 0; j < N_ITERATIONS; j++)
+    {
+      memcpy(buffer, buffers[i], BUFFER_SIZE);
+      message.field_count = MAX_FIELDS;
+
+      start = __rdtscp(&aux);
+      ff_deserialize(buffer, BUFFER_SIZE, &message);
+      end = __rdtscp(&aux);
+
+      fused_cycles += (end - start);
+
+      memcpy(buffer, buffers[i], BUFFER_SIZE);
+      message.field_count = MAX_FIELDS;
+
+      start = __rdtscp(&aux);
+      ff_deserialize_batch(batch_buffers, batch_sizes, &message, batch_lengths, 1);
+      end = __rdtscp(&aux);
+
+      separate_cycles += (end - start);
+    }
+  
+    dprintf(fd, "%d, %lu, %lu\n", i + 1, fused_cycles / N_ITERATIONS, separate_cycles / N_ITERATIONS);
+  }
+
+  free(message.fields);
+  close(fd);
+}
+
+//ff_deserialize needs a private copy of the message to overwrite, ff_deserialize_const parses the original buffer
+static void deserialize_const(char **buffers)
+{
+  const int32_t fd = open_p("benchmark_deserialize_const.csv", O_TRUNC | O_CREAT | O_WRONLY, 0644);
+  
+  uint64_t start, end;
+  uint32_t aux;
+  
+  fix_message_t message ALIGNED(ALIGNMENT) = {0};
+  message.fields = calloc_p(MAX_FIELDS, sizeof(fix_field_t));
+  
+  dprintf(fd, "# of fields, # of cpu cycles (copy + ff_deserialize), # of cpu cycles (ff_deserialize_const)\n");
+  for (uint16_t i = 0; i < MAX_FIELDS; i++)
+  {
+    char buffer[BUFFER_SIZE] ALIGNED(ALIGNMENT);
+    uint64_t copy_cycles = 0;
+    uint64_t const_cycles = 0;
+    
+    for (uint32_t j = 0; j < N_ITERATIONS; j++)
+    {
+      message.field_count = MAX_FIELDS;
+
+      start = __rdtscp(&aux);
+      memcpy(buffer, buffers[i], BUFFER_SIZE);
+      ff_deserialize(buffer, BUFFER_SIZE, &message);
+      end = __rdtscp(&aux);
+
+      copy_cycles += (end - start);
+
+      message.field_count = MAX_FIELDS;
+
+      start = __rdtscp(&aux);
+      ff_deserialize_const(buffers[i], BUFFER_SIZE, &message);
+      end = __rdtscp(&aux);
+
+      const_cycles += (end - start);
+    }
+  
+    dprintf(fd, "%d, %lu, %lu\n", i + 1, copy_cycles / N_ITERATIONS, const_cycles / N_ITERATIONS);
+  }
+
+  free(message.fields);
+  close(fd);
+}
+
+//parses a capture file of the benchmark messages with ff_capture_parse, best of REPLAY_RUNS for each thread count
+static void replay(char **buffers)
+{
+  const int32_t fd = open_p("benchmark_replay.csv", O_TRUNC | O_CREAT | O_WRONLY, 0644);
+  const char *path = "benchmark_replay.fix";
+
+  const int32_t capture_fd = open_p(path, O_TRUNC | O_CREAT | O_WRONLY, 0644);
+  uint64_t written = 0;
+  for (uint32_t i = 0; written < REPLAY_SIZE; i = (i + 1) % MAX_FIELDS)
+  {
+    const size_t len = strlen(buffers[i]);
+    if (write(capture_fd, buffers[i], len) != (ssize_t)len)
+    {
+      perror("write");
+      exit(1);
+    }
+    written += len;
+  }
+  close(capture_fd);
+
+  ff_capture_t capture;
+  if (!ff_capture_open(&capture, path))
+  {
+    perror("ff_capture_open");
+    exit(1);
+  }
+
+  const long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  dprintf(fd, "# of threads, bytes per second\n");
+  for (long n_threads = 1; n_threads <= n_cpus; n_threads = (n_threads * 2 > n_cpus && n_threads < n_cpus) ? n_cpus : n_threads * 2)
+  {
+    double best = 0;
+
+    for (uint32_t j = 0; j < REPLAY_RUNS; j++)
+    {
+      struct timespec start, end;
+      uint64_t message_count;
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      const bool parsed = ff_capture_parse(&capture, n_threads, MAX_FIELDS, discard_message, NULL, &message_count);
+      clock_gettime(CLOCK_MONOTONIC, &end);
+
+      if (!parsed)
+      {
+        fprintf(stderr, "ff_capture_parse: stopped after %lu messages\n", message_count);
+        exit(1);
+      }
+
+      const double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+      const double bytes_per_second = capture.size / seconds;
+      best = (bytes_per_second > best) ? bytes_per_second : best;
+    }
+
+    dprintf(fd, "%ld, %.0f\n", n_threads, best);
+  }
+
+  ff_capture_close(&capture);
+  unlink(path);
+  close(fd);
+}
+
+//the parse is measured alone, ff_capture_parse already counts the messages
+static void discard_message(const fix_message_t *message, const char *raw, const uint16_t len, const uint16_t thread, void *context)
+{
+  (void)message;
+  (void)raw;
+  (void)len;
+  (void)thread;
+  (void)context;
+}
+
 static char *generate_random_string(const char *charset, const uint8_t charset_len, const uint16_t median_len, const uint16_t max_len)
 {
   uint16_t len = gaussian_rand(median_len, 1);
@@ -282,7 +496,7 @@ static inline uint16_t clamp(const uint16_t n, const uint16_t min, const uint16_
   return n < min ? min : n > max ? max : n;
 }
 
-static uint8_t compute_checksum(const char *buffer, const uint16_t len)
+static uint8_t reference_checksum(const char *buffer, const uint16_t len)
 {
   uint8_t checksum = 0;
   for (uint16_t i = 0; i < len; i++)
@@ -0,0 +1,55 @@
+/*================================================================================
+
+File: batch.h                                                                   
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 07:21:46                                                 
+last edited: 2026-10-17 07:59:01                                                
+
+================================================================================*/
+
+#ifndef FLASHFIX_BATCH_H
+# define FLASHFIX_BATCH_H
+
+# include <stdint.h>
+
+# include "structs.h"
+# include "clock.h"
+
+# define FF_BATCH_MAX_SEGMENTS 16
+
+typedef struct
+{
+  const ff_clock_t *clock;
+  int64_t latency_budget;
+  uint32_t segment_size;
+  uint8_t segment_count;
+  bool zerocopy;
+} ff_batch_config_t;
+
+typedef struct
+{
+  int32_t fd;
+  bool zerocopy;
+  const ff_clock_t *clock;
+  int64_t latency_budget;
+  int64_t first_pending;
+  char *arena;
+  uint32_t segment_size;
+  uint8_t segment_count;
+  uint8_t segment;
+  uint32_t len;
+  uint16_t pending;
+  uint32_t next_send_id;
+  uint32_t completed;
+  uint32_t segment_ids[FF_BATCH_MAX_SEGMENTS];
+} ff_batch_t;
+
+bool ff_batch_create(ff_batch_t *restrict batch, const int32_t fd, const ff_batch_config_t *restrict config);
+void ff_batch_destroy(ff_batch_t *batch);
+bool ff_batch_add(ff_batch_t *restrict batch, const fix_message_t *restrict message);
+bool ff_batch_flush(ff_batch_t *batch);
+bool ff_batch_poll(ff_batch_t *batch);
+
+#endif
@@ -0,0 +1,33 @@
+/*================================================================================
+
+File: capture.h                                                                 
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 07:26:48                                                 
+last edited: 2026-10-17 08:01:34                                                
+
+================================================================================*/
+
+#ifndef FLASHFIX_CAPTURE_H
+# define FLASHFIX_CAPTURE_H
+
+# include <stdint.h>
+# include <stddef.h>
+
+# include "structs.h"
+
+typedef struct
+{
+  int32_t fd;
+  const char *map;
+  size_t size;
+} ff_capture_t;
+
+typedef void (*ff_capture_callback_t)(const fix_message_t *message, const char *raw, const uint16_t len, const uint16_t thread, void *context);
+
+bool ff_capture_open(ff_capture_t *restrict capture, const char *restrict path);
+void ff_capture_close(ff_capture_t *capture);
+bool ff_capture_parse(const ff_capture_t *restrict capture, uint16_t n_threads, const uint16_t max_fields, ff_capture_callback_t callback, void *context, uint64_t *restrict message_count);
+
+#endif
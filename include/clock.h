@@ -0,0 +1,37 @@
+/*================================================================================
+
+File: clock.h                                                                   
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:40:04                                                 
+last edited: 2026-10-17 06:40:04                                                
+
+================================================================================*/
+
+#ifndef FLASHFIX_CLOCK_H
+# define FLASHFIX_CLOCK_H
+
+# include <stdint.h>
+
+# define FF_TIMESTAMP_MAX_LEN 32
+
+typedef struct
+{
+  uint64_t tsc_base;
+  int64_t ns_base;
+  uint64_t ns_per_tick;
+  bool tsc;
+  uint8_t precision;
+  uint8_t len;
+  int64_t second;
+  char timestamp[FF_TIMESTAMP_MAX_LEN];
+} ff_clock_t;
+
+bool ff_clock_init(ff_clock_t *clock, const uint8_t precision);
+void ff_clock_calibrate(ff_clock_t *clock);
+int64_t ff_clock_now(const ff_clock_t *clock);
+uint8_t ff_clock_format(ff_clock_t *restrict clock, const int64_t ns, char *restrict buffer);
+uint8_t ff_clock_timestamp(ff_clock_t *restrict clock, char *restrict buffer);
+
+#endif
\ No newline at end of file
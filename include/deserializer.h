@@ -5,7 +5,7 @@ Creator: Claudio Raimondi
 Email: claudio.raimondi@pm.me                                                   
 
 created at: 2025-02-11 12:37:26                                                 
-last edited: 2025-02-28 19:14:47                                                
+last edited: 2026-10-17 07:08:55                                                
 
 ================================================================================*/
 
@@ -16,7 +16,31 @@ last edited: 2025-02-28 19:14:47
 
 # include "structs.h"
 
+typedef enum
+{
+  FF_PARSER_HEADER,
+  FF_PARSER_BODY,
+  FF_PARSER_DONE,
+  FF_PARSER_ERROR
+} ff_parser_state_t;
+
+typedef struct
+{
+  uint8_t state;
+  uint8_t checksum;
+  uint16_t body_start;
+  uint16_t checksum_start;
+  uint16_t checksummed;
+  uint16_t tokenized;
+  uint16_t field_count;
+  uint16_t max_fields;
+} ff_parser_t;
+
 uint16_t ff_deserialize(char *restrict buffer, const uint16_t buffer_size, fix_message_t *restrict message);
+uint16_t ff_deserialize_const(const char *buffer, const uint16_t buffer_size, fix_message_t *restrict message);
+uint16_t ff_deserialize_compact(char *buffer, const uint16_t buffer_size, fix_compact_message_t *restrict message);
+uint16_t ff_deserialize_batch(char *const *restrict buffers, const uint16_t *restrict buffer_sizes, fix_message_t *restrict messages, uint16_t *restrict lengths, const uint16_t count);
+uint16_t ff_deserialize_incremental(ff_parser_t *restrict parser, char *restrict buffer, const uint16_t len, fix_message_t *restrict message);
 bool ff_is_complete(const char *buffer, const uint16_t len);
 
 #endif
\ No newline at end of file
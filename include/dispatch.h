@@ -0,0 +1,17 @@
+/*================================================================================
+
+File: dispatch.h                                                                
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:27:53                                                 
+last edited: 2026-10-17 06:27:53                                                
+
+================================================================================*/
+
+#ifndef FLASHFIX_DISPATCH_H
+# define FLASHFIX_DISPATCH_H
+
+const char *ff_isa(void);
+
+#endif
\ No newline at end of file
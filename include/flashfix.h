@@ -5,7 +5,7 @@ Creator: Claudio Raimondi
 Email: claudio.raimondi@pm.me                                                   
 
 created at: 2025-02-12 13:35:28                                                 
-last edited: 2025-02-24 16:35:15                                                
+last edited: 2026-10-17 07:30:34                                                
 
 ================================================================================*/
 
@@ -18,6 +18,19 @@ last edited: 2025-02-24 16:35:15
 
 # include "serializer.h"
 # include "deserializer.h"
+# include "stream.h"
+# include "dispatch.h"
+# include "lookup.h"
+# include "values.h"
+# include "clock.h"
+# include "template.h"
+# include "groups.h"
+# include "market_data.h"
+# include "session.h"
+# include "uring.h"
+# include "batch.h"
+# include "journal.h"
+# include "capture.h"
 
 //TODO explore <stdbit.h> for bit manipulation
 
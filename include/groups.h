@@ -0,0 +1,73 @@
+/*================================================================================
+
+File: groups.h                                                                  
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:54:22                                                 
+last edited: 2026-10-17 06:54:22                                                
+
+================================================================================*/
+
+#ifndef FLASHFIX_GROUPS_H
+# define FLASHFIX_GROUPS_H
+
+# include <stdint.h>
+
+# include "structs.h"
+
+# define FF_GROUP_NO_PARENT UINT16_MAX
+
+//dictionary entry of a repeating group: every entry starts with delimiter_tag and only contains member_tags and nested groups
+typedef struct ff_group_def_s
+{
+  uint32_t count_tag;
+  uint32_t delimiter_tag;
+  const uint32_t *member_tags;
+  uint8_t member_count;
+  uint8_t subgroup_count;
+  const struct ff_group_def_s *subgroups;
+} ff_group_def_t;
+
+typedef struct
+{
+  uint32_t count_tag;
+  uint16_t start;
+  uint16_t end;
+  uint16_t entry_count;
+  uint16_t first_entry;
+  uint16_t parent;
+  uint16_t parent_entry;
+} ff_group_t;
+
+typedef struct
+{
+  ff_group_t *groups;
+  uint16_t *entries;
+  uint16_t group_capacity;
+  uint16_t entry_capacity;
+  uint16_t group_count;
+  uint16_t entry_count;
+} ff_groups_t;
+
+typedef struct ff_group_data_s ff_group_data_t;
+
+typedef struct
+{
+  const fix_field_t *fields;
+  uint16_t field_count;
+  uint8_t group_count;
+  const ff_group_data_t *groups;
+} ff_entry_data_t;
+
+struct ff_group_data_s
+{
+  uint32_t count_tag;
+  uint16_t entry_count;
+  const ff_entry_data_t *entries;
+};
+
+bool ff_get_groups(const fix_message_t *restrict message, const ff_group_def_t *restrict defs, const uint8_t def_count, ff_groups_t *restrict groups);
+char *ff_serialize_groups(char *restrict buffer, const fix_message_t *restrict message, const ff_group_data_t *restrict groups, const uint8_t group_count, uint16_t *restrict len);
+
+#endif
\ No newline at end of file
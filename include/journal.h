@@ -0,0 +1,49 @@
+/*================================================================================
+
+File: journal.h                                                                 
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 07:24:23                                                 
+last edited: 2026-10-17 08:00:28                                                
+
+================================================================================*/
+
+#ifndef FLASHFIX_JOURNAL_H
+# define FLASHFIX_JOURNAL_H
+
+# include <stdint.h>
+# include <stddef.h>
+
+# include "structs.h"
+
+typedef struct
+{
+  uint64_t magic;
+  uint64_t data_size;
+  uint32_t capacity;
+  uint32_t first_seq;
+  uint32_t count;
+  uint32_t durable_count;
+} ff_journal_header_t;
+
+typedef struct
+{
+  int32_t fd;
+  char *map;
+  size_t map_size;
+  ff_journal_header_t *header;
+  uint64_t *index;
+  char *data;
+  uint32_t synced_count;
+} ff_journal_t;
+
+bool ff_journal_open(ff_journal_t *restrict journal, const char *restrict path, const uint32_t capacity, const uint64_t data_size);
+void ff_journal_close(ff_journal_t *journal);
+bool ff_journal_append(ff_journal_t *restrict journal, const uint32_t seq_num, const char *restrict message, const uint16_t len);
+bool ff_journal_append_message(ff_journal_t *restrict journal, const uint32_t seq_num, const fix_message_t *restrict message);
+const char *ff_journal_read(const ff_journal_t *restrict journal, const uint32_t begin, uint32_t end, uint64_t *restrict len);
+uint32_t ff_journal_next_seq(const ff_journal_t *journal);
+bool ff_journal_sync(ff_journal_t *journal, const bool wait);
+
+#endif
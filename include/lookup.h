@@ -0,0 +1,21 @@
+/*================================================================================
+
+File: lookup.h                                                                  
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:30:45                                                 
+last edited: 2026-10-17 06:30:45                                                
+
+================================================================================*/
+
+#ifndef FLASHFIX_LOOKUP_H
+# define FLASHFIX_LOOKUP_H
+
+# include <stdint.h>
+
+# include "structs.h"
+
+const fix_field_t *ff_get_field(const fix_message_t *restrict message, const uint32_t tag);
+
+#endif
\ No newline at end of file
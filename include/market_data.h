@@ -0,0 +1,37 @@
+/*================================================================================
+
+File: market_data.h                                                             
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:57:48                                                 
+last edited: 2026-10-17 06:57:48                                                
+
+================================================================================*/
+
+#ifndef FLASHFIX_MARKET_DATA_H
+# define FLASHFIX_MARKET_DATA_H
+
+# include <stdint.h>
+
+typedef uint32_t (*ff_symbol_resolver_t)(void *context, const char *symbol, const uint16_t symbol_len);
+
+//one column per MDEntry field, entry i of the message is row i of every column
+typedef struct
+{
+  char *actions;
+  char *types;
+  uint32_t *symbols;
+  int64_t *prices;
+  int64_t *sizes;
+  int64_t *times;
+  uint16_t capacity;
+  uint16_t count;
+  uint8_t price_scale;
+  ff_symbol_resolver_t resolve_symbol;
+  void *resolver_context;
+} ff_md_columns_t;
+
+uint16_t ff_decode_md_incremental(char *restrict buffer, const uint16_t buffer_size, ff_md_columns_t *restrict columns);
+
+#endif
\ No newline at end of file
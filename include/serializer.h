@@ -5,7 +5,7 @@ Creator: Claudio Raimondi
 Email: claudio.raimondi@pm.me                                                   
 
 created at: 2025-02-11 12:37:26                                                 
-last edited: 2025-02-25 14:58:53                                                
+last edited: 2026-10-17 07:52:29                                                
 
 ================================================================================*/
 
@@ -16,7 +16,19 @@ last edited: 2025-02-25 14:58:53
 
 # include "structs.h"
 
+# define FF_MAX_ENCODED_LEN 24
+# define FF_HEADER_RESERVED_LEN 18
+# define FF_ENCODE_MAX_SCALE 19
+
 uint16_t ff_serialize(char *restrict buffer, const fix_message_t *restrict message);
+char *ff_serialize_reserved(char *restrict buffer, const fix_message_t *restrict message, uint16_t *restrict len);
+uint16_t ff_serialize_compact(char *restrict buffer, const fix_compact_message_t *restrict message);
 uint16_t ff_serialize_raw(char *restrict buffer, const fix_message_t *restrict message);
+uint8_t ff_encode_uint(char *restrict buffer, const uint64_t value);
+uint8_t ff_encode_int(char *restrict buffer, const int64_t value);
+//0 if scale is above FF_ENCODE_MAX_SCALE
+uint8_t ff_encode_decimal(char *restrict buffer, const int64_t value, const uint8_t scale);
+//0 for NaN, infinities and magnitudes below 1e-4 or from 1e17 up that have no exact form with fewer digits
+uint8_t ff_encode_double(char *restrict buffer, const double value);
 
 #endif
\ No newline at end of file
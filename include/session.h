@@ -0,0 +1,81 @@
+/*================================================================================
+
+File: session.h                                                                 
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 07:10:20                                                 
+last edited: 2026-10-17 07:10:20                                                
+
+================================================================================*/
+
+#ifndef FLASHFIX_SESSION_H
+# define FLASHFIX_SESSION_H
+
+# include <stdint.h>
+
+# include "structs.h"
+# include "template.h"
+# include "clock.h"
+
+# define FF_SESSION_ADMIN_MESSAGES 7
+# define FF_SESSION_ADMIN_BUFFER_SIZE 256
+# define FF_SESSION_COMP_ID_MAX_LEN 64
+# define FF_SESSION_TEST_REQ_ID_MAX_LEN 32
+
+//slots that the templates passed to ff_session_send must reserve first, in this order
+# define FF_SESSION_SLOT_SEQ_NUM 0
+# define FF_SESSION_SLOT_SENDING_TIME 1
+
+typedef enum
+{
+  FF_SESSION_DISCONNECTED,
+  FF_SESSION_LOGON_SENT,
+  FF_SESSION_ACTIVE,
+  FF_SESSION_LOGOUT_SENT,
+  FF_SESSION_CLOSED
+} ff_session_state_t;
+
+typedef enum
+{
+  FF_SESSION_EVENT_NONE,
+  FF_SESSION_EVENT_APP,
+  FF_SESSION_EVENT_LOGON,
+  FF_SESSION_EVENT_LOGOUT,
+  FF_SESSION_EVENT_GAP,
+  FF_SESSION_EVENT_TIMEOUT,
+  FF_SESSION_EVENT_ERROR
+} ff_session_event_t;
+
+typedef struct
+{
+  const char *sender_comp_id;
+  const char *target_comp_id;
+  uint16_t heartbeat_interval;
+} ff_session_config_t;
+
+typedef struct
+{
+  int32_t fd;
+  ff_session_state_t state;
+  uint32_t next_outbound;
+  uint32_t next_inbound;
+  int64_t heartbeat_interval;
+  int64_t last_sent;
+  int64_t last_received;
+  int64_t test_request_sent;
+  bool test_request_pending;
+  bool resend_pending;
+  ff_clock_t clock;
+  ff_template_t admin[FF_SESSION_ADMIN_MESSAGES];
+  char buffers[FF_SESSION_ADMIN_MESSAGES][FF_SESSION_ADMIN_BUFFER_SIZE];
+} ff_session_t;
+
+bool ff_session_create(ff_session_t *restrict session, const int32_t fd, const ff_session_config_t *restrict config);
+bool ff_session_logon(ff_session_t *session);
+bool ff_session_logout(ff_session_t *session);
+bool ff_session_send(ff_session_t *restrict session, ff_template_t *restrict tpl);
+ff_session_event_t ff_session_on_message(ff_session_t *restrict session, const fix_message_t *restrict message);
+ff_session_event_t ff_session_poll(ff_session_t *session);
+
+#endif
@@ -0,0 +1,35 @@
+/*================================================================================
+
+File: stream.h                                                                  
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:19:23                                                 
+last edited: 2026-10-17 07:47:40                                                
+
+================================================================================*/
+
+#ifndef FLASHFIX_STREAM_H
+# define FLASHFIX_STREAM_H
+
+# include <stdint.h>
+
+# include "structs.h"
+
+typedef struct
+{
+  char *buffer;
+  uint32_t capacity;
+  uint32_t head;
+  uint32_t tail;
+  uint16_t rejected;
+} ff_stream_t;
+
+bool ff_stream_create(ff_stream_t *stream, const uint32_t capacity);
+void ff_stream_destroy(ff_stream_t *stream);
+char *ff_stream_recv_buffer(ff_stream_t *restrict stream, uint32_t *restrict available);
+void ff_stream_commit(ff_stream_t *stream, const uint32_t len);
+uint16_t ff_stream_deserialize(ff_stream_t *restrict stream, fix_message_t *restrict messages, const uint16_t max_messages, uint32_t *restrict consumed);
+void ff_stream_skip(ff_stream_t *stream);
+
+#endif
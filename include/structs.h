@@ -5,7 +5,7 @@ Creator: Claudio Raimondi
 Email: claudio.raimondi@pm.me                                                   
 
 created at: 2025-02-13 13:38:07                                                 
-last edited: 2025-03-04 12:18:32                                                
+last edited: 2026-10-17 07:49:52                                                
 
 ================================================================================*/
 
@@ -14,10 +14,31 @@ last edited: 2025-03-04 12:18:32
 
 # include <stdint.h>
 
+# define FF_PARSE_TAGS 0x01
+# define FF_KEEP_DELIMITERS 0x02
+
+# define FF_INDEX_DIRECT_TAGS 1024
+# define FF_INDEX_HASHED_SLOTS 64
+
+//position of the first occurrence of each tag, entries stamped with an older generation are empty
+typedef struct
+{
+  uint16_t generation;
+  bool overflow;
+  uint64_t presence;
+  uint32_t direct[FF_INDEX_DIRECT_TAGS];
+  struct
+  {
+    uint32_t tag;
+    uint32_t stamp;
+  } hashed[FF_INDEX_HASHED_SLOTS];
+} fix_tag_index_t;
+
 typedef struct
 {
   uint16_t tag_len;
   uint16_t value_len;
+  uint32_t tag_num;
   char *tag;
   char *value;
 } fix_field_t;
@@ -26,6 +47,18 @@ typedef struct
 {
   fix_field_t *fields;
   uint16_t field_count;
+  fix_tag_index_t *index;
+  uint16_t flags;
 } fix_message_t;
 
+//offsets relative to buffer, one entry per field in each array: 6 bytes of metadata per field instead of 24
+typedef struct
+{
+  char *buffer;
+  uint16_t *tags;
+  uint16_t *values;
+  uint16_t *value_lens;
+  uint16_t field_count;
+} fix_compact_message_t;
+
 #endif
\ No newline at end of file
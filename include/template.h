@@ -0,0 +1,57 @@
+/*================================================================================
+
+File: template.h                                                                
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:41:30                                                 
+last edited: 2026-10-17 06:53:46                                                
+
+================================================================================*/
+
+#ifndef FLASHFIX_TEMPLATE_H
+# define FLASHFIX_TEMPLATE_H
+
+# include <stdint.h>
+
+# include "structs.h"
+# include "serializer.h"
+
+# define FF_TEMPLATE_MAX_SLOTS 16
+# define FF_TEMPLATE_HEADER_SIZE FF_HEADER_RESERVED_LEN
+
+typedef struct
+{
+  uint32_t tag;
+  uint8_t width;
+  bool variable;
+} ff_slot_def_t;
+
+typedef struct
+{
+  uint16_t offset;
+  uint8_t len;
+  uint8_t width;
+  bool variable;
+  uint8_t sum;
+} ff_template_slot_t;
+
+typedef struct
+{
+  char *buffer;
+  uint16_t capacity;
+  uint16_t body_end;
+  uint16_t body_len;
+  uint8_t body_sum;
+  uint8_t header_sum;
+  uint8_t header_len;
+  uint8_t slot_count;
+  ff_template_slot_t slots[FF_TEMPLATE_MAX_SLOTS];
+} ff_template_t;
+
+bool ff_template_create(ff_template_t *restrict tpl, char *restrict buffer, const uint16_t capacity, const fix_message_t *restrict message, const ff_slot_def_t *restrict defs, const uint8_t def_count);
+bool ff_template_set(ff_template_t *restrict tpl, const uint8_t slot, const char *restrict value, const uint8_t len);
+bool ff_template_set_uint(ff_template_t *restrict tpl, const uint8_t slot, const uint64_t value);
+uint16_t ff_template_finalize(ff_template_t *restrict tpl, const char **restrict message);
+
+#endif
\ No newline at end of file
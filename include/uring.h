@@ -0,0 +1,74 @@
+/*================================================================================
+
+File: uring.h                                                                   
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 07:15:01                                                 
+last edited: 2026-10-17 07:57:13                                                
+
+================================================================================*/
+
+#ifndef FLASHFIX_URING_H
+# define FLASHFIX_URING_H
+
+# include <stdint.h>
+# include <stddef.h>
+
+# include "structs.h"
+
+# define FF_URING_NO_BUFFER -1
+
+typedef struct
+{
+  uint16_t buffer_count;
+  uint32_t buffer_size;
+  bool sqpoll;
+  bool busy_poll;
+} ff_uring_config_t;
+
+typedef struct
+{
+  int32_t ring_fd;
+  int32_t socket_fd;
+  bool sqpoll;
+  bool busy_poll;
+  bool armed;
+  bool closed;
+  void *sq_ring;
+  void *cq_ring;
+  void *sqes;
+  size_t sq_ring_size;
+  size_t cq_ring_size;
+  size_t sqes_size;
+  uint32_t *sq_tail;
+  uint32_t *sq_flags;
+  uint32_t *sq_array;
+  uint32_t sq_mask;
+  uint32_t *cq_head;
+  uint32_t *cq_tail;
+  uint32_t cq_mask;
+  void *cqes;
+  void *buf_ring;
+  size_t buf_ring_size;
+  char *buffers;
+  uint32_t buffer_size;
+  uint16_t buffer_count;
+  uint16_t buf_tail;
+  uint16_t held;
+  int32_t current;
+  uint32_t current_offset;
+  uint32_t current_len;
+  char *carry;
+  char *spare;
+  uint32_t carry_len;
+  uint16_t rejected;
+} ff_uring_t;
+
+bool ff_uring_create(ff_uring_t *restrict uring, const int32_t fd, const ff_uring_config_t *restrict config);
+void ff_uring_destroy(ff_uring_t *uring);
+uint16_t ff_uring_receive(ff_uring_t *restrict uring, fix_message_t *restrict messages, const uint16_t max_messages, int32_t *restrict buffer_id);
+void ff_uring_skip(ff_uring_t *uring);
+void ff_uring_release(ff_uring_t *uring, const int32_t buffer_id);
+
+#endif
@@ -0,0 +1,26 @@
+/*================================================================================
+
+File: values.h                                                                  
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:34:41                                                 
+last edited: 2026-10-17 07:03:24                                                
+
+================================================================================*/
+
+#ifndef FLASHFIX_VALUES_H
+# define FLASHFIX_VALUES_H
+
+# include <stdint.h>
+
+# include "structs.h"
+
+# define FF_DECIMAL_MAX_DIGITS 18
+
+bool ff_decode_decimal(const char *restrict value, const uint16_t value_len, const uint8_t scale, int64_t *restrict result);
+bool ff_decode_timestamp(const char *restrict value, const uint16_t value_len, int64_t *restrict result);
+bool ff_decode_time(const char *restrict value, const uint16_t value_len, int64_t *restrict result);
+uint64_t ff_decode_decimals(const fix_message_t *restrict message, const uint32_t *restrict tags, const uint8_t *restrict scales, int64_t *restrict results, const uint8_t count);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,215 @@
+/*================================================================================
+
+File: batch.c                                                                   
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 07:21:47                                                 
+last edited: 2026-10-17 07:59:01                                                
+
+================================================================================*/
+
+#include "common.h"
+#include "batch.h"
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/errqueue.h>
+
+static bool send_segment(ff_batch_t *restrict batch, const char *restrict data, uint32_t len);
+static bool wait_segment(ff_batch_t *batch);
+static bool wait_completion(const ff_batch_t *batch);
+static void reap_completions(ff_batch_t *batch);
+static inline bool segment_busy(const ff_batch_t *batch, const uint8_t segment);
+
+/*
+  the arena is split in segment_count segments: messages are serialized back to back in the current one, which is sent
+  with a single sendmsg when it is full or when its oldest message has waited latency_budget ns.
+  with zerocopy the kernel sends straight from the arena, so a segment is written again only after the kernel reported
+  the completion of its last sendmsg.
+*/
+bool ff_batch_create(ff_batch_t *restrict batch, const int32_t fd, const ff_batch_config_t *restrict config)
+{
+  if (UNLIKELY(!config->segment_count || config->segment_count > FF_BATCH_MAX_SEGMENTS || !config->segment_size))
+    return false;
+
+  const size_t arena_size = (size_t)config->segment_count * config->segment_size;
+  char *const arena = mmap(NULL, arena_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+  if (UNLIKELY(arena == MAP_FAILED))
+    return false;
+
+  //both are best effort: pinning is limited by RLIMIT_MEMLOCK, zerocopy needs a TCP or UDP socket
+  mlock(arena, arena_size);
+  const int32_t one = 1;
+  const bool zerocopy = config->zerocopy && (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0);
+
+  *batch = (ff_batch_t){
+    .fd = fd,
+    .zerocopy = zerocopy,
+    .clock = config->clock,
+    .latency_budget = config->latency_budget,
+    .arena = arena,
+    .segment_size = config->segment_size,
+    .segment_count = config->segment_count
+  };
+
+  return true;
+}
+
+//the kernel keeps its own references to the pages still being sent
+void ff_batch_destroy(ff_batch_t *batch)
+{
+  munmap(batch->arena, (size_t)batch->segment_count * batch->segment_size);
+  *batch = (ff_batch_t){ .fd = -1 };
+}
+
+//serializes message at the end of the current segment, a message that doesn't fit starts a new one
+bool ff_batch_add(ff_batch_t *restrict batch, const fix_message_t *restrict message)
+{
+  const uint16_t body_length = compute_body_length(message->fields, message->field_count);
+  const uint32_t len = STR_LEN("8=FIX.4.4\x01""9=\x01") + count_digits(body_length) + body_length + STR_LEN("10=000\x01");
+  if (UNLIKELY(len > batch->segment_size))
+    return false;
+
+  if (UNLIKELY(batch->len + len > batch->segment_size) && UNLIKELY(!ff_batch_flush(batch)))
+    return false;
+
+  if (!batch->len)
+  {
+    if (UNLIKELY(!wait_segment(batch)))
+      return false;
+    batch->first_pending = ff_clock_now(batch->clock);
+  }
+
+  char *const buffer = batch->arena + (size_t)batch->segment * batch->segment_size + batch->len;
+  batch->len += serialize_message(buffer, message, body_length);
+  batch->pending++;
+
+  if (ff_clock_now(batch->clock) - batch->first_pending >= batch->latency_budget)
+    return ff_batch_flush(batch);
+
+  return true;
+}
+
+bool ff_batch_flush(ff_batch_t *batch)
+{
+  if (!batch->len)
+    return true;
+
+  const char *const segment = batch->arena + (size_t)batch->segment * batch->segment_size;
+  const bool sent = send_segment(batch, segment, batch->len);
+
+  batch->segment_ids[batch->segment] = batch->next_send_id;
+  batch->segment = (batch->segment + 1) % batch->segment_count;
+  batch->len = 0;
+  batch->pending = 0;
+  return sent;
+}
+
+//to be called from the event loop: flushes the messages that exhausted the latency budget and collects the completions
+bool ff_batch_poll(ff_batch_t *batch)
+{
+  if (batch->zerocopy)
+    reap_completions(batch);
+
+  if (batch->len && ff_clock_now(batch->clock) - batch->first_pending >= batch->latency_budget)
+    return ff_batch_flush(batch);
+
+  return true;
+}
+
+//each sendmsg with MSG_ZEROCOPY, even a partial one, takes the next completion id
+static bool send_segment(ff_batch_t *restrict batch, const char *restrict data, uint32_t len)
+{
+  const int32_t flags = MSG_NOSIGNAL | (batch->zerocopy ? MSG_ZEROCOPY : 0);
+
+  while (len)
+  {
+    struct iovec iov = { .iov_base = (void *)data, .iov_len = len };
+    const struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1 };
+
+    const ssize_t sent = sendmsg(batch->fd, &msg, flags);
+    if (UNLIKELY(sent < 0))
+    {
+      //ENOBUFS means too many zerocopy sends are still in flight, the next completion makes room
+      if (errno == ENOBUFS && batch->zerocopy && batch->completed != batch->next_send_id)
+      {
+        const uint32_t completed = batch->completed;
+        reap_completions(batch);
+        if (batch->completed == completed && UNLIKELY(!wait_completion(batch)))
+          return false;
+        continue;
+      }
+      if (errno == EAGAIN)
+      {
+        struct pollfd pfd = { .fd = batch->fd, .events = POLLOUT };
+        poll(&pfd, 1, -1);
+        continue;
+      }
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+
+    batch->next_send_id += batch->zerocopy;
+    data += sent;
+    len -= sent;
+  }
+
+  return true;
+}
+
+static bool wait_segment(ff_batch_t *batch)
+{
+  while (UNLIKELY(segment_busy(batch, batch->segment)))
+  {
+    reap_completions(batch);
+    if (!segment_busy(batch, batch->segment))
+      break;
+
+    if (UNLIKELY(!wait_completion(batch)))
+      return false;
+  }
+
+  return true;
+}
+
+//completions are reported as errors, poll wakes up on them without asking for any event
+static bool wait_completion(const ff_batch_t *batch)
+{
+  struct pollfd pfd = { .fd = batch->fd, .events = 0 };
+  return poll(&pfd, 1, -1) >= 0 || errno == EINTR;
+}
+
+//TCP reports the completions in order, each one covers the ids from ee_info to ee_data
+static void reap_completions(ff_batch_t *batch)
+{
+  char control[256];
+
+  while (true)
+  {
+    struct msghdr msg = { .msg_control = control, .msg_controllen = sizeof(control) };
+    if (recvmsg(batch->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+      return;
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+      const bool recverr = (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+      if (!recverr)
+        continue;
+
+      const struct sock_extended_err *const err = (const struct sock_extended_err *)CMSG_DATA(cmsg);
+      if (err->ee_origin == SO_EE_ORIGIN_ZEROCOPY && (int32_t)(err->ee_data + 1 - batch->completed) > 0)
+        batch->completed = err->ee_data + 1;
+    }
+  }
+}
+
+//segment_ids holds the id following the last sendmsg of each segment
+static inline bool segment_busy(const ff_batch_t *batch, const uint8_t segment)
+{
+  return batch->zerocopy && (int32_t)(batch->segment_ids[segment] - batch->completed) > 0;
+}
@@ -0,0 +1,236 @@
+/*================================================================================
+
+File: capture.c                                                                 
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 07:26:49                                                 
+last edited: 2026-10-17 08:01:34                                                
+
+================================================================================*/
+
+#include "common.h"
+#include "capture.h"
+#include "deserializer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SEARCH_WINDOW (1U << 30)
+
+typedef struct
+{
+  const char *start;
+  const char *end;
+  uint16_t thread;
+  uint16_t max_fields;
+  ff_capture_callback_t callback;
+  void *context;
+  uint64_t message_count;
+  pthread_t id;
+  bool spawned;
+  bool failed;
+} worker_t;
+
+static const char *find_boundary(const char *buffer, const char *const end);
+static const char *search(const char *buffer, const char *const end);
+static bool is_message_start(const char *buffer, const char *const end);
+static void *parse_chunk(void *arg);
+
+bool ff_capture_open(ff_capture_t *restrict capture, const char *restrict path)
+{
+  *capture = (ff_capture_t){ .fd = -1 };
+
+  const int32_t fd = open(path, O_RDONLY);
+  if (UNLIKELY(fd < 0))
+    return false;
+
+  struct stat st;
+  if (UNLIKELY(fstat(fd, &st) < 0))
+  {
+    close(fd);
+    return false;
+  }
+
+  capture->fd = fd;
+  capture->size = st.st_size;
+  if (!capture->size)
+    return true;
+
+  //read only: the messages are parsed in place with ff_deserialize_const, no page is ever copied
+  const char *const map = mmap(NULL, capture->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (UNLIKELY(map == MAP_FAILED))
+  {
+    close(fd);
+    *capture = (ff_capture_t){ .fd = -1 };
+    return false;
+  }
+
+  madvise((void *)map, capture->size, MADV_SEQUENTIAL);
+  capture->map = map;
+  return true;
+}
+
+void ff_capture_close(ff_capture_t *capture)
+{
+  if (capture->map)
+    munmap((void *)capture->map, capture->size);
+  if (capture->fd >= 0)
+    close(capture->fd);
+
+  *capture = (ff_capture_t){ .fd = -1 };
+}
+
+/*
+  the file is split in n_threads chunks of the same size (0 for one per online cpu). each chunk is moved forward to
+  the first real message, an "8=FIX" whose BodyLength leads to a "10=" field, so every message is parsed by exactly
+  one thread. thread i gets chunk i and sees its messages in file order.
+  corrupted bytes are skipped, a valid message with more than max_fields fields stops its chunk and fails the call.
+*/
+bool ff_capture_parse(const ff_capture_t *restrict capture, uint16_t n_threads, const uint16_t max_fields, ff_capture_callback_t callback, void *context, uint64_t *restrict message_count)
+{
+  *message_count = 0;
+
+  if (!n_threads)
+  {
+    const int64_t n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    n_threads = (n_cpus > 0) ? ((n_cpus < UINT16_MAX) ? n_cpus : UINT16_MAX) : 1;
+  }
+
+  if (UNLIKELY(!capture->size || !max_fields))
+    return !capture->size;
+
+  worker_t *const workers = calloc(n_threads, sizeof(worker_t));
+  if (UNLIKELY(!workers))
+    return false;
+
+  const char *const map_end = capture->map + capture->size;
+  const size_t chunk_size = capture->size / n_threads;
+
+  workers[0].start = capture->map;
+  for (uint16_t i = 1; i < n_threads; i++)
+  {
+    const char *const nominal = capture->map + i * chunk_size;
+    workers[i].start = (nominal > workers[i - 1].start) ? find_boundary(nominal, map_end) : workers[i - 1].start;
+  }
+
+  for (uint16_t i = 0; i < n_threads; i++)
+  {
+    workers[i].end = (i + 1 < n_threads) ? workers[i + 1].start : map_end;
+    workers[i].thread = i;
+    workers[i].max_fields = max_fields;
+    workers[i].callback = callback;
+    workers[i].context = context;
+  }
+
+  //the first chunk runs on the calling thread, a chunk whose thread can't be started too
+  for (uint16_t i = 1; i < n_threads; i++)
+    workers[i].spawned = (pthread_create(&workers[i].id, NULL, parse_chunk, &workers[i]) == 0);
+
+  bool parsed = true;
+  for (uint16_t i = 0; i < n_threads; i++)
+  {
+    if (workers[i].spawned)
+      pthread_join(workers[i].id, NULL);
+    else
+      parse_chunk(&workers[i]);
+    *message_count += workers[i].message_count;
+    parsed &= !workers[i].failed;
+  }
+
+  free(workers);
+  return parsed;
+}
+
+static const char *find_boundary(const char *buffer, const char *const end)
+{
+  while (LIKELY(buffer < end))
+  {
+    const char *const candidate = search(buffer, end);
+    if (UNLIKELY(!candidate))
+      return end;
+
+    if (LIKELY(is_message_start(candidate, end)))
+      return candidate;
+
+    buffer = candidate + 1;
+  }
+
+  return end;
+}
+
+//find_begin_string works on ranges that fit an int32_t, a capture can be much larger
+static const char *search(const char *buffer, const char *const end)
+{
+  while (LIKELY(buffer < end))
+  {
+    const char *const window_end = ((size_t)(end - buffer) > SEARCH_WINDOW) ? buffer + SEARCH_WINDOW : end;
+    const char *const candidate = find_begin_string(buffer, window_end);
+    if (LIKELY(candidate) || window_end == end)
+      return candidate;
+
+    buffer = window_end - STR_LEN("8=FIX") + 1;
+  }
+
+  return NULL;
+}
+
+static bool is_message_start(const char *buffer, const char *const end)
+{
+  const size_t remaining = end - buffer;
+  const uint16_t len = (remaining > UINT16_MAX) ? UINT16_MAX : remaining;
+  const int32_t checksum_offset = get_checksum_offset(buffer, len);
+
+  bool valid = (checksum_offset > 0) && (checksum_offset + STR_LEN("10=000\x01") <= remaining);
+  valid = valid && memcmp(buffer + checksum_offset, "10=", STR_LEN("10=")) == 0;
+  return valid && buffer[checksum_offset + STR_LEN("10=000")] == '\x01';
+}
+
+static void *parse_chunk(void *arg)
+{
+  worker_t *const worker = arg;
+  fix_field_t *const fields = calloc(worker->max_fields, sizeof(fix_field_t));
+  if (UNLIKELY(!fields))
+  {
+    worker->failed = true;
+    return NULL;
+  }
+
+  fix_message_t message = { .fields = fields };
+  const char *buffer = worker->start;
+  const char *const end = worker->end;
+
+  while (LIKELY(buffer < end))
+  {
+    const size_t remaining = end - buffer;
+    const uint16_t len = (remaining > UINT16_MAX) ? UINT16_MAX : remaining;
+
+    message.field_count = worker->max_fields;
+    const uint16_t message_len = ff_deserialize_const(buffer, len, &message);
+    if (LIKELY(message_len))
+    {
+      worker->callback(&message, buffer, message_len, worker->thread, worker->context);
+      worker->message_count++;
+      buffer += message_len;
+      continue;
+    }
+
+    //the const parse doesn't write the buffer, so it is left as it is
+    if (UNLIKELY(rejected_length((char *)buffer, len, false)))
+    {
+      worker->failed = true;
+      break;
+    }
+
+    buffer = search(buffer + 1, end);
+    if (UNLIKELY(!buffer))
+      break;
+  }
+
+  free(fields);
+  return NULL;
+}
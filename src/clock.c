@@ -0,0 +1,179 @@
+/*================================================================================
+
+File: clock.c                                                                   
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:40:04                                                 
+last edited: 2026-10-17 07:53:11                                                
+
+================================================================================*/
+
+#include "common.h"
+#include "clock.h"
+#include <cpuid.h>
+#include <string.h>
+#include <time.h>
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+static bool has_invariant_tsc(void);
+static int64_t realtime_ns(void);
+static void render_date(char *restrict timestamp, const int64_t days);
+static inline void render_time(char *restrict timestamp, const uint32_t second_of_day);
+static inline void render_fraction(char *restrict fraction, uint32_t value, const uint8_t len);
+
+#define NS_PER_SECOND 1000000000LL
+#define SECONDS_PER_DAY 86400
+#define CALIBRATION_NS 10000000LL
+
+//precision is the number of decimals of the seconds: 0, 3, 6 or 9. clock->tsc tells whether the TSC is used as clock source
+bool ff_clock_init(ff_clock_t *clock, const uint8_t precision)
+{
+  if (UNLIKELY(precision > 9 || precision % 3))
+    return false;
+
+  *clock = (ff_clock_t){
+    .tsc = has_invariant_tsc(),
+    .precision = precision,
+    .len = STR_LEN("YYYYMMDD-HH:MM:SS") + (precision ? precision + 1 : 0),
+    .second = -1,
+  };
+
+  memcpy(clock->timestamp, "19700101-00:00:00.000000000", STR_LEN("YYYYMMDD-HH:MM:SS.sssssssss"));
+
+  if (LIKELY(clock->tsc))
+    ff_clock_calibrate(clock);
+
+  return true;
+}
+
+/*
+  measures the TSC frequency against CLOCK_REALTIME, spinning for CALIBRATION_NS.
+  call it again off the hot path to follow NTP adjustments.
+*/
+void ff_clock_calibrate(ff_clock_t *clock)
+{
+  const int64_t ns_start = realtime_ns();
+  const uint64_t tsc_start = __rdtsc();
+
+  int64_t ns_end;
+  do
+    ns_end = realtime_ns();
+  while (ns_end - ns_start < CALIBRATION_NS);
+  const uint64_t tsc_end = __rdtsc();
+
+  clock->ns_per_tick = ((uint128_t)(ns_end - ns_start) << 32) / (tsc_end - tsc_start);
+  clock->tsc_base = tsc_end;
+  clock->ns_base = ns_end;
+}
+
+//nanoseconds since the epoch, without a vDSO call when the TSC is usable
+int64_t ff_clock_now(const ff_clock_t *clock)
+{
+  if (UNLIKELY(!clock->tsc))
+    return realtime_ns();
+
+  const uint64_t ticks = __rdtsc() - clock->tsc_base;
+  return clock->ns_base + (int64_t)(((uint128_t)ticks * clock->ns_per_tick) >> 32);
+}
+
+/*
+  formats ns as a UTCTimestamp into buffer, not NUL terminated.
+  the last rendered timestamp is cached: the date is rendered again only when the day changes, the time when the second
+  changes (just the seconds when the minute is the same), the fraction is always patched.
+*/
+uint8_t ff_clock_format(ff_clock_t *restrict clock, const int64_t ns, char *restrict buffer)
+{
+  const int64_t second = ns / NS_PER_SECOND;
+  const uint32_t subsecond = ns - second * NS_PER_SECOND;
+  char *const timestamp = clock->timestamp;
+
+  if (UNLIKELY(second != clock->second))
+  {
+    const int64_t day = second / SECONDS_PER_DAY;
+    const uint32_t second_of_day = second - day * SECONDS_PER_DAY;
+
+    const bool rendered = (clock->second >= 0);
+
+    if (LIKELY(rendered && second / 60 == clock->second / 60))
+      memcpy2(timestamp + STR_LEN("YYYYMMDD-HH:MM:"), digit_pairs + ((second_of_day % 60) << 1));
+    else
+    {
+      if (UNLIKELY(!rendered || day != clock->second / SECONDS_PER_DAY))
+        render_date(timestamp, day);
+      render_time(timestamp, second_of_day);
+    }
+
+    clock->second = second;
+  }
+
+  const uint8_t precision = clock->precision;
+  render_fraction(timestamp + STR_LEN("YYYYMMDD-HH:MM:SS."), subsecond / (uint32_t)powers_of_10[9 - precision], precision);
+
+  memcpy(buffer, timestamp, clock->len);
+  return clock->len;
+}
+
+uint8_t ff_clock_timestamp(ff_clock_t *restrict clock, char *restrict buffer)
+{
+  return ff_clock_format(clock, ff_clock_now(clock), buffer);
+}
+
+static bool has_invariant_tsc(void)
+{
+  uint32_t eax, ebx, ecx, edx;
+
+  if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+    return false;
+
+  return edx & (1U << 8);
+}
+
+static int64_t realtime_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return ts.tv_sec * NS_PER_SECOND + ts.tv_nsec;
+}
+
+//days since the epoch to a proleptic gregorian date, the inverse of the conversion in values.c
+COLD static void render_date(char *restrict timestamp, const int64_t days)
+{
+  const int64_t z = days + 719468;
+  const int64_t era = z / 146097;
+  const uint32_t day_of_era = z - era * 146097;
+  const uint32_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+  const uint32_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+  const uint32_t mp = (5 * day_of_year + 2) / 153;
+  const uint32_t day = day_of_year - (153 * mp + 2) / 5 + 1;
+  const uint32_t month = mp < 10 ? mp + 3 : mp - 9;
+  const uint32_t year = year_of_era + era * 400 + (month <= 2);
+
+  memcpy2(timestamp, digit_pairs + ((year / 100) << 1));
+  memcpy2(timestamp + 2, digit_pairs + ((year % 100) << 1));
+  memcpy2(timestamp + 4, digit_pairs + (month << 1));
+  memcpy2(timestamp + 6, digit_pairs + (day << 1));
+}
+
+static inline void render_time(char *restrict timestamp, const uint32_t second_of_day)
+{
+  memcpy2(timestamp + STR_LEN("YYYYMMDD-"), digit_pairs + ((second_of_day / 3600) << 1));
+  memcpy2(timestamp + STR_LEN("YYYYMMDD-HH:"), digit_pairs + ((second_of_day / 60 % 60) << 1));
+  memcpy2(timestamp + STR_LEN("YYYYMMDD-HH:MM:"), digit_pairs + ((second_of_day % 60) << 1));
+}
+
+static inline void render_fraction(char *restrict fraction, uint32_t value, const uint8_t len)
+{
+  char *cursor = fraction + len;
+
+  while (cursor - fraction >= 2)
+  {
+    cursor -= 2;
+    memcpy2(cursor, digit_pairs + ((value % 100) << 1));
+    value /= 100;
+  }
+
+  if (cursor > fraction)
+    *--cursor = '0' + value;
+}
\ No newline at end of file
@@ -5,112 +5,120 @@ Creator: Claudio Raimondi
 Email: claudio.raimondi@pm.me                                                   
 
 created at: 2025-02-24 16:35:15                                                 
-last edited: 2025-03-02 21:57:40                                                
+last edited: 2026-10-17 06:39:28                                                
 
 ================================================================================*/
 
 #include "common.h"
-
-#ifdef __AVX512F__
-  static __m512i _512_vec_zeros;
-#endif
-
-#ifdef __AVX2__
-  static __m256i _256_vec_zeros;
-#endif
-
-#ifdef __SSE2__
-  static __m128i _128_vec_zeros;
-#endif
-
+#include "dispatch.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const kernels_t *select_kernels(void);
+
+static const kernels_t *const tiers[] = {
+  &kernels_avx512,
+  &kernels_avx2,
+  &kernels_sse4,
+  &kernels_generic
+};
+
+const kernels_t *kernels = &kernels_generic;
+
+const uint64_t powers_of_10[20] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+  10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+  1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+const char digit_pairs[] =
+  "00" "01" "02" "03" "04" "05" "06" "07" "08" "09"
+  "10" "11" "12" "13" "14" "15" "16" "17" "18" "19"
+  "20" "21" "22" "23" "24" "25" "26" "27" "28" "29"
+  "30" "31" "32" "33" "34" "35" "36" "37" "38" "39"
+  "40" "41" "42" "43" "44" "45" "46" "47" "48" "49"
+  "50" "51" "52" "53" "54" "55" "56" "57" "58" "59"
+  "60" "61" "62" "63" "64" "65" "66" "67" "68" "69"
+  "70" "71" "72" "73" "74" "75" "76" "77" "78" "79"
+  "80" "81" "82" "83" "84" "85" "86" "87" "88" "89"
+  "90" "91" "92" "93" "94" "95" "96" "97" "98" "99";
+
+//picks the widest tier the cpu supports, FLASHFIX_ISA can force a narrower one (e.g. for A/B benchmarks)
 CONSTRUCTOR void ff_common_init(void)
 {
-#ifdef __AVX512F__
-  _512_vec_zeros = _mm512_setzero_si512();
-#endif
-
-#ifdef __AVX2__
-  _256_vec_zeros = _mm256_setzero_si256();
-#endif
-
-#ifdef __SSE2__
-  _128_vec_zeros = _mm_setzero_si128();
-#endif
+  kernels = select_kernels();
 }
 
-uint8_t compute_checksum(const char *buffer,  const char *const end)
+const char *ff_isa(void)
 {
-  uint16_t remaining = end - buffer;
-  
-  uint8_t misaligned_bytes = align_forward(buffer);
-  misaligned_bytes -= (misaligned_bytes > remaining) * (misaligned_bytes - remaining);
-
-  uint8_t checksum = 0;
+  return kernels->name;
+}
 
-  while (UNLIKELY(misaligned_bytes--))
+/*
+  length-guided framing: reads BodyLength and returns the offset at which "10=" is expected.
+  returns 0 if the header is not fully received yet, -1 if it is malformed.
+*/
+int32_t get_checksum_offset(const char *buffer, const uint16_t len)
+{
+  if (UNLIKELY(len < STR_LEN("8=FIX.4.4\x01""9=")))
+    return 0;
+
+  bool valid = memcmp8(buffer, "8=FIX.4.4");
+  valid &= memcmp4(buffer + 8, "4\x01""9=");
+  if (UNLIKELY(!valid))
+    return -1;
+
+  const char *digits = buffer + STR_LEN("8=FIX.4.4\x01""9=");
+  const char *const digits_start = digits;
+  const uint16_t max_digits = STR_LEN("65535") + 1;
+  const char *const end = buffer + len;
+  const char *const digits_end = (end - digits > max_digits) ? digits + max_digits : end;
+  uint32_t body_length = 0;
+
+  while (LIKELY(digits < digits_end && (uint8_t)(*digits - '0') < 10))
   {
-    checksum += *buffer++;
-    remaining--;
+    body_length = mul10(body_length) + (*digits - '0');
+    digits++;
   }
 
-#ifdef __AVX512F__
-  while (LIKELY(remaining >= 64))
-  {
-    const __m512i vec = _mm512_load_si512((const __m512i *)buffer);
-    const __m512i sum = _mm512_sad_epu8(vec, _512_vec_zeros);
-    checksum += (uint8_t)_mm512_reduce_add_epi64(sum);
+  const uint8_t n_digits = digits - digits_start;
+  if (UNLIKELY(n_digits > STR_LEN("65535") || body_length > UINT16_MAX))
+    return -1;
 
-    buffer += 64;
-    remaining -= 64;
-  }
-#endif
+  if (UNLIKELY(digits == end))
+    return 0;
 
-#ifdef __AVX2__
-  while (LIKELY(remaining >= 32))
-  {
-    const __m256i vec = _mm256_load_si256((const __m256i *)buffer);
-    const __m256i sum = _mm256_sad_epu8(vec, _256_vec_zeros);
-    
-    const __m128i sum_low = _mm256_extracti128_si256(sum, 0);
-    const __m128i sum_high = _mm256_extracti128_si256(sum, 1);
-    const __m128i sum_total = _mm_add_epi64(sum_low, sum_high);
+  valid = (n_digits > 0) & (*digits == '\x01');
+  if (UNLIKELY(!valid))
+    return -1;
 
-    checksum += (uint8_t)(_mm_extract_epi64(sum_total, 0) + _mm_extract_epi64(sum_total, 1));
+  return (digits + 1 - buffer) + body_length;
+}
 
-    buffer += 32;
-    remaining -= 32;
-  }
-#endif
+static const kernels_t *select_kernels(void)
+{
+  __builtin_cpu_init();
 
-#ifdef __SSE4_1__
-  while (LIKELY(remaining >= 16))
-  {
-    const __m128i vec = _mm_load_si128((const __m128i *)buffer);
-    const __m128i sum = _mm_sad_epu8(vec, _128_vec_zeros);
+  const bool supported[] = {
+    __builtin_cpu_supports("x86-64-v4"),
+    __builtin_cpu_supports("x86-64-v3"),
+    __builtin_cpu_supports("x86-64-v2"),
+    true
+  };
 
-    checksum += (uint8_t)(_mm_extract_epi64(sum, 0) + _mm_extract_epi64(sum, 1));
+  const char *const forced = getenv("FLASHFIX_ISA");
+  uint8_t i = 0;
 
-    buffer += 16;
-    remaining -= 16;
-  }
-#endif
+  while (!supported[i])
+    i++;
 
-  while (LIKELY(remaining >= 8))
+  if (UNLIKELY(forced))
   {
-    uint64_t chunk = *(const uint64_t *)buffer;
-
-    chunk = (chunk & 0x00FF00FF00FF00FFULL) + ((chunk >> 8) & 0x00FF00FF00FF00FFULL);
-    chunk = (chunk & 0x0000FFFF0000FFFFULL) + ((chunk >> 16) & 0x0000FFFF0000FFFFULL);
-    chunk = (chunk & 0x00000000FFFFFFFFULL) + (chunk >> 32);
-
-    checksum += (uint8_t)chunk;
-    
-    buffer += 8;
-    remaining -= 8;
+    uint8_t j = i;
+    while (j < sizeof(tiers) / sizeof(tiers[0]) && strcmp(tiers[j]->name, forced))
+      j++;
+    i = (j < sizeof(tiers) / sizeof(tiers[0])) ? j : i;
   }
 
-  while (LIKELY(remaining--))
-    checksum += *buffer++;
-
-  return checksum;
+  return tiers[i];
 }
\ No newline at end of file
@@ -5,7 +5,7 @@ Creator: Claudio Raimondi
 Email: claudio.raimondi@pm.me                                                   
 
 created at: 2025-02-11 14:56:11                                                 
-last edited: 2025-03-05 20:59:03                                                
+last edited: 2026-10-17 07:47:40                                                
 
 ================================================================================*/
 
@@ -17,6 +17,7 @@ last edited: 2025-03-05 20:59:03
 //#TODO #include <stdbit.h>
 
 # include "extensions.h"
+# include "structs.h"
 
 # define STR_LEN(x) (sizeof(x) - 1)
 
@@ -30,7 +31,76 @@ last edited: 2025-03-05 20:59:03
   # define ALIGNMENT sizeof(void *)
 # endif
 
-INTERNAL uint8_t compute_checksum(const char *buffer, const char *const end);
+# define CHECKSUM_LANES 4
+# define BLOCK_SIZE 64
+
+# define TIMESTAMP_SIZE 32
+
+typedef struct
+{
+  uint16_t year;
+  uint8_t month;
+  uint8_t day;
+  uint8_t hour;
+  uint8_t minute;
+  uint8_t second;
+  uint32_t nanosecond;
+} timestamp_t;
+
+typedef bool (*field_visitor_t)(void *context, const uint32_t tag, const char *value, const uint16_t value_len);
+
+//every hot kernel is compiled once per ISA tier (see src/kernels), the widest supported tier is selected at load time
+typedef struct
+{
+  const char *name;
+  uint8_t (*compute_checksum)(const char *buffer, const char *const end);
+  void (*compute_checksums)(const char *const *buffers, const char *const *ends, uint8_t *checksums);
+  const char *(*get_checksum_start)(const char *buffer, const uint16_t buffer_size);
+  const char *(*find_begin_string)(const char *buffer, const char *const end);
+  bool (*tokenize)(char *buffer, const char *const end, fix_message_t *const restrict message);
+  bool (*scan_message)(char *buffer, char *body_start, const char *checksum_start, fix_message_t *const restrict message, uint8_t *restrict checksum);
+  bool (*scan_fields)(char *buffer, char *body_start, const char *checksum_start, field_visitor_t visitor, void *context, uint8_t *restrict checksum);
+  bool (*scan_compact)(char *buffer, char *body_start, const char *checksum_start, fix_compact_message_t *const restrict message, uint8_t *restrict checksum);
+  uint16_t (*compute_body_length)(const fix_field_t *fields, uint16_t field_count);
+  uint16_t (*compact_body_length)(const fix_compact_message_t *message);
+  bool (*parse_timestamp)(const char *restrict timestamp, timestamp_t *restrict parts);
+  char *(*write_fields)(char *restrict buffer, const fix_field_t *restrict fields, uint16_t field_count, uint8_t *restrict checksum);
+  char *(*write_compact_fields)(char *restrict buffer, const fix_compact_message_t *restrict message, uint8_t *restrict checksum);
+} kernels_t;
+
+INTERNAL extern const kernels_t kernels_generic;
+INTERNAL extern const kernels_t kernels_sse4;
+INTERNAL extern const kernels_t kernels_avx2;
+INTERNAL extern const kernels_t kernels_avx512;
+INTERNAL extern const kernels_t *kernels;
+INTERNAL extern const uint64_t powers_of_10[20];
+INTERNAL extern const char digit_pairs[];
+
+INTERNAL int32_t get_checksum_offset(const char *buffer, const uint16_t len);
+INTERNAL void index_reset(fix_tag_index_t *index);
+INTERNAL char *prepend_header(char *body, const uint16_t body_len, uint8_t *restrict checksum);
+INTERNAL uint16_t serialize_message(char *restrict buffer, const fix_message_t *restrict message, const uint16_t body_length);
+INTERNAL char *write_checksum(char *restrict buffer, const uint8_t checksum);
+INTERNAL const char *frame(const char *buffer, const uint16_t buffer_size);
+INTERNAL uint16_t rejected_length(char *buffer, const uint16_t buffer_size, const bool terminated);
+INTERNAL uint32_t atoui(const char *str, const char **endptr);
+INTERNAL ALWAYS_INLINE inline uint8_t compute_checksum(const char *buffer, const char *const end) { return kernels->compute_checksum(buffer, end); }
+INTERNAL ALWAYS_INLINE inline void compute_checksums(const char *const *buffers, const char *const *ends, uint8_t *checksums) { kernels->compute_checksums(buffers, ends, checksums); }
+INTERNAL ALWAYS_INLINE inline const char *get_checksum_start(const char *buffer, const uint16_t buffer_size) { return kernels->get_checksum_start(buffer, buffer_size); }
+INTERNAL ALWAYS_INLINE inline const char *find_begin_string(const char *buffer, const char *const end) { return kernels->find_begin_string(buffer, end); }
+INTERNAL ALWAYS_INLINE inline bool tokenize(char *buffer, const char *const end, fix_message_t *const restrict message) { return kernels->tokenize(buffer, end, message); }
+INTERNAL ALWAYS_INLINE inline bool scan_message(char *buffer, char *body_start, const char *checksum_start, fix_message_t *const restrict message, uint8_t *restrict checksum) { return kernels->scan_message(buffer, body_start, checksum_start, message, checksum); }
+INTERNAL ALWAYS_INLINE inline bool scan_fields(char *buffer, char *body_start, const char *checksum_start, field_visitor_t visitor, void *context, uint8_t *restrict checksum) { return kernels->scan_fields(buffer, body_start, checksum_start, visitor, context, checksum); }
+INTERNAL ALWAYS_INLINE inline bool scan_compact(char *buffer, char *body_start, const char *checksum_start, fix_compact_message_t *const restrict message, uint8_t *restrict checksum) { return kernels->scan_compact(buffer, body_start, checksum_start, message, checksum); }
+INTERNAL ALWAYS_INLINE inline uint16_t compute_body_length(const fix_field_t *fields, uint16_t field_count) { return kernels->compute_body_length(fields, field_count); }
+INTERNAL ALWAYS_INLINE inline uint16_t compact_body_length(const fix_compact_message_t *message) { return kernels->compact_body_length(message); }
+INTERNAL ALWAYS_INLINE inline bool parse_timestamp(const char *restrict timestamp, timestamp_t *restrict parts) { return kernels->parse_timestamp(timestamp, parts); }
+INTERNAL ALWAYS_INLINE inline char *write_fields(char *restrict buffer, const fix_field_t *restrict fields, uint16_t field_count, uint8_t *restrict checksum) { return kernels->write_fields(buffer, fields, field_count, checksum); }
+INTERNAL ALWAYS_INLINE inline char *write_compact_fields(char *restrict buffer, const fix_compact_message_t *restrict message, uint8_t *restrict checksum) { return kernels->write_compact_fields(buffer, message, checksum); }
+INTERNAL ALWAYS_INLINE inline uint32_t mul10(const uint32_t n) { return (n << 3) + (n << 1); }
+INTERNAL ALWAYS_INLINE inline uint8_t count_digits(const uint64_t n) { const uint8_t guess = ((64 - __builtin_clzll(n | 1)) * 1233) >> 12; return guess + 1 - ((n | 1) < powers_of_10[guess]); }
+INTERNAL ALWAYS_INLINE inline bool swar_is_digits(const uint64_t digits) { return !(((digits + 0x7676767676767676ULL) | digits) & 0x8080808080808080ULL); }
+INTERNAL ALWAYS_INLINE inline uint8_t index_slot(const uint32_t tag) { return (tag * 0x9E3779B1U) >> (32 - __builtin_ctz(FF_INDEX_HASHED_SLOTS)); }
 INTERNAL ALWAYS_INLINE inline uint8_t align_forward(const void *const ptr) { return -(uintptr_t)ptr & (ALIGNMENT - 1);}
 INTERNAL ALWAYS_INLINE inline uint8_t memcmp8(const void *const ptr1, const void *const ptr2) { return *(uint64_t *)ptr1 == *(uint64_t *)ptr2; }
 INTERNAL ALWAYS_INLINE inline uint8_t memcmp4(const void *const ptr1, const void *const ptr2) { return *(uint32_t *)ptr1 == *(uint32_t *)ptr2; }
@@ -38,5 +108,100 @@ INTERNAL ALWAYS_INLINE inline uint8_t memcmp2(const void *const ptr1, const void
 INTERNAL ALWAYS_INLINE inline void memcpy8(void *const dest, const void *const src) { *(uint64_t *)dest = *(uint64_t *)src; }
 INTERNAL ALWAYS_INLINE inline void memcpy4(void *const dest, const void *const src) { *(uint32_t *)dest = *(uint32_t *)src; }
 INTERNAL ALWAYS_INLINE inline void memcpy2(void *const dest, const void *const src) { *(uint16_t *)dest = *(uint16_t *)src; }
+INTERNAL ALWAYS_INLINE inline bool check_zero_equal_soh(const char *buffer) { return memcmp2(buffer, "0=") & (buffer[5] == '\x01'); }
+INTERNAL ALWAYS_INLINE inline bool check_checksum_tag(const char *buffer) { return (buffer[0] == '1') & check_zero_equal_soh(buffer + 1); }
+
+//8 digits (already minus '0'), most significant first in memory order, combined pairwise in 3 steps
+INTERNAL ALWAYS_INLINE inline uint32_t swar_combine8(uint64_t digits)
+{
+  digits = (digits * 10 + (digits >> 8)) & 0x00FF00FF00FF00FFULL;
+  digits = (digits * 100 + (digits >> 16)) & 0x0000FFFF0000FFFFULL;
+  digits = (digits * 10000 + (digits >> 32)) & 0x00000000FFFFFFFFULL;
+  return digits;
+}
+
+/*
+  SWAR conversion of a tag of up to 8 digits: the 8 bytes ending at the '=' are loaded at once, so the tag lands
+  in the high bytes already right aligned. the bytes before it belong to the header or the previous field.
+  returns 0 (not a valid tag) if the tag is empty, too long or not numeric.
+*/
+INTERNAL ALWAYS_INLINE inline uint32_t parse_tag(const char *tag, const uint16_t tag_len)
+{
+  if (UNLIKELY((uint16_t)(tag_len - 1) >= sizeof(uint64_t)))
+  {
+    if (tag_len != STR_LEN("999999999"))
+      return 0;
+
+    uint32_t tag_num = 0;
+    for (uint8_t i = 0; i < STR_LEN("999999999"); i++)
+    {
+      const uint8_t digit = tag[i] - '0';
+      if (UNLIKELY(digit >= 10))
+        return 0;
+      tag_num = mul10(tag_num) + digit;
+    }
+    return tag_num;
+  }
+
+  const uint64_t mask = ~0ULL << ((sizeof(uint64_t) - tag_len) << 3);
+  const uint64_t digits = (*(const uint64_t *)(tag + tag_len - sizeof(uint64_t)) & mask) - (0x3030303030303030ULL & mask);
+
+  if (UNLIKELY(!swar_is_digits(digits)))
+    return 0;
+
+  return swar_combine8(digits);
+}
+
+//plain conversion for tags that aren't inside a message buffer, UINT32_MAX if the tag isn't numeric
+INTERNAL ALWAYS_INLINE inline uint32_t tag_to_uint(const char *tag, const uint16_t tag_len)
+{
+  uint32_t result = 0;
+
+  for (uint16_t i = 0; i < tag_len; i++)
+  {
+    const uint8_t digit = tag[i] - '0';
+    if (UNLIKELY(digit >= 10))
+      return UINT32_MAX;
+
+    result = mul10(result) + digit;
+  }
+
+  return result;
+}
+
+//records the first occurrence of a tag, tags below 64 also set their presence bit
+INTERNAL ALWAYS_INLINE inline void index_field(fix_tag_index_t *restrict index, const uint32_t tag_num, const uint16_t field)
+{
+  if (UNLIKELY(!tag_num))
+    return;
+
+  const uint32_t stamp = ((uint32_t)index->generation << 16) | field;
+
+  if (LIKELY(tag_num < FF_INDEX_DIRECT_TAGS))
+  {
+    index->presence |= (uint64_t)(tag_num < 64) << (tag_num & 63);
+    if ((index->direct[tag_num] >> 16) != index->generation)
+      index->direct[tag_num] = stamp;
+    return;
+  }
+
+  uint8_t slot = index_slot(tag_num);
+  for (uint8_t probes = 0; probes < FF_INDEX_HASHED_SLOTS; probes++)
+  {
+    if ((index->hashed[slot].stamp >> 16) != index->generation)
+    {
+      index->hashed[slot].tag = tag_num;
+      index->hashed[slot].stamp = stamp;
+      return;
+    }
+
+    if (index->hashed[slot].tag == tag_num)
+      return;
+
+    slot = (slot + 1) & (FF_INDEX_HASHED_SLOTS - 1);
+  }
+
+  index->overflow = true;
+}
 
 #endif
\ No newline at end of file
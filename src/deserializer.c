@@ -5,7 +5,7 @@ Creator: Claudio Raimondi
 Email: claudio.raimondi@pm.me                                                   
 
 created at: 2025-02-11 12:37:26                                                 
-last edited: 2025-03-05 20:59:03                                                
+last edited: 2026-10-17 07:47:40                                                
 
 ================================================================================*/
 
@@ -13,263 +13,282 @@ last edited: 2025-03-05 20:59:03
 #include "deserializer.h"
 #include <string.h>
 
-static const char *get_checksum_start(const char *buffer, const uint16_t buffer_size);
-static inline bool check_zero_equal_soh(const char *buffer);
-static bool tokenize(char *buffer, const char *const end, fix_message_t *const restrict message);
-static uint32_t atoui(const char *str, const char **endptr);
-static inline uint32_t mul10(uint32_t n);
-
-//TODO find a way to make them const, forcing prevention of thread safety issues, constexpr??
-#ifdef __AVX512F__
-  static __m512i _512_vec_ones;
-  static __m512i _512_vec_zeros;
-  static __m512i _512_vec_equals; 
-  static __m512i _512_vec_soh;
-#endif
-
-#ifdef __AVX2__
-  static __m256i _256_vec_ones;
-  static __m256i _256_vec_zeros;
-  static __m256i _256_vec_equals;
-  static __m256i _256_vec_soh;
-#endif
-
-#ifdef __SSE2__
-  static __m128i _128_vec_ones;
-  static __m128i _128_vec_zeros;
-  static __m128i _128_vec_equals;
-  static __m128i _128_vec_soh;
-#endif
-
-CONSTRUCTOR void ff_deserializer_init(void)
-{
-#ifdef __AVX512F__
-  _512_vec_ones   = _mm512_set1_epi8('1');
-  _512_vec_zeros  = _mm512_set1_epi8('0');
-  _512_vec_equals = _mm512_set1_epi8('=');
-  _512_vec_soh    = _mm512_set1_epi8('\x01');
-#endif
-
-#ifdef __AVX2__
-  _256_vec_ones   = _mm256_set1_epi8('1');
-  _256_vec_zeros  = _mm256_set1_epi8('0');
-  _256_vec_equals = _mm256_set1_epi8('=');
-  _256_vec_soh    = _mm256_set1_epi8('\x01');
-#endif
-
-#ifdef __SSE2__
-  _128_vec_ones   = _mm_set1_epi8('1');
-  _128_vec_zeros  = _mm_set1_epi8('0');
-  _128_vec_equals = _mm_set1_epi8('=');
-  _128_vec_soh    = _mm_set1_epi8('\x01');
-#endif
-}
+static uint16_t finalize(char *buffer, const char *checksum_start, const uint8_t checksum, fix_message_t *restrict message);
+static bool parse_header(ff_parser_t *restrict parser, const char *restrict buffer, const uint16_t len, const fix_message_t *restrict message);
+static bool parse_body(ff_parser_t *restrict parser, char *restrict buffer, const uint16_t len, const fix_message_t *restrict message);
+static void restore_delimiters(char *buffer, const char *const end);
 
 uint16_t ff_deserialize(char *buffer, const uint16_t buffer_size, fix_message_t *restrict message)
 {
-  const char *const buffer_start = buffer;
+  const char *const checksum_start = frame(buffer, buffer_size);
+  if (UNLIKELY(!checksum_start))
+    return 0;
 
-  bool valid = buffer_size >= STR_LEN("8=FIX.4.4\x019=0\x01""10=000\x01");
-  valid &= memcmp8(buffer, "8=FIX.4.4");
-  buffer += 8;
-  valid &= memcmp4(buffer, "4\x01""9=");
-  buffer += 4;
+  char *const body_start = (char *)rawmemchr(buffer + STR_LEN("8=FIX.4.4\x01""9="), '\x01') + 1;
+  const char *checksum_end;
+  const uint8_t provided_checksum = (uint8_t)atoui(checksum_start + STR_LEN("10="), &checksum_end);
 
-  if (UNLIKELY(!valid))
-    return 0;  
+  if (message->index)
+    index_reset(message->index);
 
-  const uint16_t body_length = (uint16_t)atoui(buffer, (const char **)&buffer);
-  if (UNLIKELY(*buffer++ != '\x01'))
-    return 0;
+  uint8_t checksum;
+  bool valid = scan_message(buffer, body_start, checksum_start, message, &checksum);
+  valid &= (checksum == provided_checksum);
+  return (checksum_end + STR_LEN("\x01") - buffer) * valid;
+}
 
-  const uint16_t remaining = buffer_size - (buffer - buffer_start);
-  const char *const body_start = buffer;
-  const char *const checksum_start = get_checksum_start(buffer, remaining);
+//the buffer is only read when the delimiters are kept, so it can be mapped read-only
+uint16_t ff_deserialize_const(const char *buffer, const uint16_t buffer_size, fix_message_t *restrict message)
+{
+  const uint16_t flags = message->flags;
+  message->flags |= FF_KEEP_DELIMITERS;
 
-  valid = (checksum_start != NULL) & (body_length == checksum_start - body_start);
-  if (UNLIKELY(!valid))
+  const uint16_t len = ff_deserialize((char *)buffer, buffer_size, message);
+
+  message->flags = flags;
+  return len;
+}
+
+//same as ff_deserialize, but fills the offsets of a compact message and doesn't overwrite the delimiters
+uint16_t ff_deserialize_compact(char *buffer, const uint16_t buffer_size, fix_compact_message_t *restrict message)
+{
+  const char *const checksum_start = frame(buffer, buffer_size);
+  if (UNLIKELY(!checksum_start))
     return 0;
 
-  buffer = (char *)checksum_start + STR_LEN("10=");
+  char *const body_start = (char *)rawmemchr(buffer + STR_LEN("8=FIX.4.4\x01""9="), '\x01') + 1;
+  const char *checksum_end;
+  const uint8_t provided_checksum = (uint8_t)atoui(checksum_start + STR_LEN("10="), &checksum_end);
 
-  const uint8_t expected_checksum = compute_checksum(buffer_start, checksum_start);
-  const uint8_t provided_checksum = (uint8_t)atoui(buffer, (const char **)&buffer);
-  buffer += STR_LEN("\x01");
+  message->buffer = buffer;
 
-  valid = (expected_checksum == provided_checksum);
-  valid &= tokenize((char *)body_start, checksum_start, message);
-  return (buffer - buffer_start) * valid;
+  uint8_t checksum;
+  bool valid = scan_compact(buffer, body_start, checksum_start, message, &checksum);
+  valid &= (checksum == provided_checksum);
+  return (checksum_end + STR_LEN("\x01") - buffer) * valid;
 }
 
-bool ff_is_complete(const char *buffer, const uint16_t len)
+/*
+  messages are processed in groups of CHECKSUM_LANES: the group is framed while the next one is prefetched,
+  the checksums are accumulated side by side, and each body is tokenized while the next one is prefetched.
+*/
+uint16_t ff_deserialize_batch(char *const *restrict buffers, const uint16_t *restrict buffer_sizes, fix_message_t *restrict messages, uint16_t *restrict lengths, const uint16_t count)
 {
-  return !!get_checksum_start(buffer, len);
-}
+  uint16_t deserialized = 0;
 
-//TODO optimize, bottleneck, 93% of the time spent here
-static const char *get_checksum_start(const char *buffer, const uint16_t buffer_size)
-{
-  int32_t remaining = buffer_size - STR_LEN("10=000\x01") + 1;
-  if (UNLIKELY(remaining <= 0))
-    return NULL;
+  for (uint16_t i = 0; LIKELY(i < count); i += CHECKSUM_LANES)
+  {
+    const uint16_t group_size = (count - i < CHECKSUM_LANES) ? count - i : CHECKSUM_LANES;
+    const uint16_t next_group_size = (count - i - group_size < CHECKSUM_LANES) ? count - i - group_size : CHECKSUM_LANES;
 
-  uint8_t misaligned_bytes = align_forward(buffer);
-  misaligned_bytes -= (misaligned_bytes > remaining) * (misaligned_bytes - remaining);
+    const char *starts[CHECKSUM_LANES];
+    const char *ends[CHECKSUM_LANES];
+    uint8_t checksums[CHECKSUM_LANES];
 
-  while (UNLIKELY(misaligned_bytes--))
-  {
-    bool found = buffer[0] == '1';
-    found &= check_zero_equal_soh(buffer + 1);
+    for (uint8_t j = 0; j < next_group_size; j++)
+      PREFETCHR(buffers[i + group_size + j], 3);
 
-    if (UNLIKELY(found))
-      return buffer;
+    for (uint8_t j = 0; j < CHECKSUM_LANES; j++)
+    {
+      const bool in_group = j < group_size;
+      const char *const buffer = buffers[i + j * in_group];
+      const char *const checksum_start = in_group ? frame(buffer, buffer_sizes[i + j]) : NULL;
 
-    buffer++;
-    remaining--;
-  }
+      starts[j] = buffer;
+      ends[j] = checksum_start ? checksum_start : buffer;
+    }
 
-#ifdef __AVX512F__
-  while (LIKELY(remaining >= 64))
-  {
-    const __m512i chunk = _mm512_load_si512((__m512i*)buffer);
-    const __m512i cmp = _mm512_cmpeq_epi8(chunk, _512_vec_ones);
-    __mmask64 mask = __mm512_movemask_epi8(cmp);
+    compute_checksums(starts, ends, checksums);
 
-    while (UNLIKELY(mask))
+    for (uint8_t j = 0; j < group_size; j++)
     {
-      const int32_t offset = __builtin_ctzll(mask);
-      const char *const candidate = buffer + offset;
+      if (LIKELY(j + 1 < group_size))
+        PREFETCHW(starts[j + 1], 3);
 
-      if (UNLIKELY(check_zero_equal_soh(candidate + 1)))
-        return candidate;
+      const bool framed = (ends[j] != starts[j]);
+      const uint16_t len = framed ? finalize(buffers[i + j], ends[j], checksums[j], &messages[i + j]) : 0;
 
-      mask &= mask - 1;
+      lengths[i + j] = len;
+      deserialized += !!len;
     }
-
-    buffer += 64;
-    remaining -= 64;
   }
-#endif
 
-#ifdef __AVX2__
-  while (LIKELY(remaining >= 32))
-  {
-    const __m256i chunk = _mm256_load_si256((__m256i *)buffer);
-    const __m256i cmp = _mm256_cmpeq_epi8(chunk, _256_vec_ones);
-    int32_t mask = _mm256_movemask_epi8(cmp);
+  return deserialized;
+}
 
-    while (UNLIKELY(mask))
-    {
-      const int32_t offset = __builtin_ctz(mask); //TODO stdc_trailing_zeros(mask);
-      const char *const candidate = buffer + offset;
+uint16_t ff_deserialize_incremental(ff_parser_t *restrict parser, char *restrict buffer, const uint16_t len, fix_message_t *restrict message)
+{
+  if (parser->state == FF_PARSER_HEADER && !parse_header(parser, buffer, len, message))
+    return 0;
 
-      if (UNLIKELY(check_zero_equal_soh(candidate + 1)))
-        return candidate;
+  if (UNLIKELY(parser->state != FF_PARSER_BODY))
+    return 0;
 
-      mask &= mask - 1;
-    }
+  if (UNLIKELY(!parse_body(parser, buffer, len, message)))
+  {
+    parser->state = FF_PARSER_ERROR;
+    return 0;
+  }
 
-    buffer += 32;
-    remaining -= 32;
+  const char *const checksum_start = buffer + parser->checksum_start;
+  if (len < parser->checksum_start + STR_LEN("10=000\x01"))
+    return 0;
+
+  const char *checksum_end;
+  bool valid = check_checksum_tag(checksum_start);
+  valid &= (parser->tokenized == parser->checksum_start);
+  valid &= (parser->checksum == (uint8_t)atoui(checksum_start + STR_LEN("10="), &checksum_end));
+  if (UNLIKELY(!valid))
+  {
+    parser->state = FF_PARSER_ERROR;
+    return 0;
   }
-#endif
 
-#ifdef __SSE2__
-  while (LIKELY(remaining >= 16))
+  message->field_count = parser->field_count;
+  parser->state = FF_PARSER_DONE;
+
+  //fields are tokenized in several chunks, the index is built once the message is complete
+  if (message->index)
   {
-    const __m128i chunk = _mm_load_si128((__m128i *)buffer);
-    const __m128i cmp = _mm_cmpeq_epi8(chunk, _128_vec_ones);
-    int32_t mask = _mm_movemask_epi8(cmp);
+    index_reset(message->index);
+    for (uint16_t i = 0; i < message->field_count; i++)
+      index_field(message->index, message->fields[i].tag_num, i);
+  }
+  return checksum_end + STR_LEN("\x01") - buffer;
+}
 
-    while (UNLIKELY(mask))
-    {
-      const int32_t offset = __builtin_ctz(mask); //TODO stdc_trailing_zeros(mask);
-      const char *const candidate = buffer + offset;
+bool ff_is_complete(const char *buffer, const uint16_t len)
+{
+  const int32_t checksum_offset = get_checksum_offset(buffer, len);
 
-      if (UNLIKELY(check_zero_equal_soh(candidate + 1)))
-        return candidate;
+  if (UNLIKELY(checksum_offset < 0))
+    return !!get_checksum_start(buffer, len);
 
-      mask &= mask - 1;
-    }
+  if (checksum_offset == 0 || checksum_offset + STR_LEN("10=000\x01") > len)
+    return false;
 
-    buffer += 16;
-    remaining -= 16;
-  }
-#endif
+  if (LIKELY(check_checksum_tag(buffer + checksum_offset)))
+    return true;
 
-  while (LIKELY(remaining >= 8))
-  {
-    const uint64_t chunk = *(const uint64_t *)buffer;
-    const uint64_t cmp = chunk ^ 0x3131313131313131ULL;
-    uint64_t mask = (cmp - 0x0101010101010101ULL) & ~cmp & 0x8080808080808080ULL;
+  return !!get_checksum_start(buffer, len);
+}
 
-    while (UNLIKELY(mask))
-    {
-      const int32_t byte_offset = __builtin_ctzll(mask) >> 3; //TODO stdc_trailing_zeros(mask) >> 3;
-      const char *const candidate = buffer + byte_offset;
+//returns the start of the checksum field, NULL if the message is incomplete or malformed
+const char *frame(const char *buffer, const uint16_t buffer_size)
+{
+  if (UNLIKELY(buffer_size < STR_LEN("8=FIX.4.4\x01""9=0\x01""10=000\x01")))
+    return NULL;
 
-      if (UNLIKELY(check_zero_equal_soh(candidate + 1)))
-        return candidate;
+  const int32_t checksum_offset = get_checksum_offset(buffer, buffer_size);
+  bool valid = (checksum_offset > 0);
+  valid &= (checksum_offset + STR_LEN("10=000\x01") <= buffer_size);
+  if (UNLIKELY(!valid))
+    return NULL;
 
-      mask &= mask - 1;
-    }
+  const char *const checksum_start = buffer + checksum_offset;
+  if (UNLIKELY(!check_checksum_tag(checksum_start)))
+    return NULL;
 
-    buffer += 8;
-    remaining -= 8;
-  }
+  return checksum_start;
+}
 
-  while (LIKELY(remaining--))
-  {
-    bool found = (buffer[0] == '1') & check_zero_equal_soh(buffer + 1);
+/*
+  called after a deserialization failed: whether the buffer starts with a complete message whose checksum is valid, which
+  then only had more fields than the message could hold (or a malformed field). the delimiters overwritten by the failed
+  attempt are put back first, so that the message can be deserialized again.
+  returns the length of the message, 0 if it is not a valid one.
+*/
+uint16_t rejected_length(char *buffer, const uint16_t buffer_size, const bool terminated)
+{
+  const char *const checksum_start = frame(buffer, buffer_size);
+  if (UNLIKELY(!checksum_start))
+    return 0;
 
-    if (UNLIKELY(found))
-      return buffer;
+  char *const body_start = (char *)rawmemchr(buffer + STR_LEN("8=FIX.4.4\x01""9="), '\x01') + 1;
+  if (terminated)
+    restore_delimiters(body_start, checksum_start);
 
-    buffer++;
-  }
+  const char *checksum_end;
+  const uint8_t provided_checksum = (uint8_t)atoui(checksum_start + STR_LEN("10="), &checksum_end);
+  const bool valid = (compute_checksum(buffer, checksum_start) == provided_checksum);
+  return (checksum_end + STR_LEN("\x01") - buffer) * valid;
+}
 
-  return NULL;
+static uint16_t finalize(char *buffer, const char *checksum_start, const uint8_t checksum, fix_message_t *restrict message)
+{
+  const char *const buffer_start = buffer;
+  char *const body_start = (char *)rawmemchr(buffer + STR_LEN("8=FIX.4.4\x01""9="), '\x01') + 1;
+  buffer = (char *)checksum_start + STR_LEN("10=");
+
+  const uint8_t provided_checksum = (uint8_t)atoui(buffer, (const char **)&buffer);
+  buffer += STR_LEN("\x01");
+
+  if (message->index)
+    index_reset(message->index);
+
+  bool valid = (checksum == provided_checksum);
+  valid &= tokenize(body_start, checksum_start, message);
+  return (buffer - buffer_start) * valid;
 }
 
-static inline bool check_zero_equal_soh(const char *buffer)
+static bool parse_header(ff_parser_t *restrict parser, const char *restrict buffer, const uint16_t len, const fix_message_t *restrict message)
 {
-  return memcmp2(buffer, "0=") & (buffer[5] == '\x01');
+  const int32_t checksum_offset = get_checksum_offset(buffer, len);
+
+  if (UNLIKELY(checksum_offset <= 0))
+  {
+    parser->state = (checksum_offset < 0) ? FF_PARSER_ERROR : FF_PARSER_HEADER;
+    return false;
+  }
+
+  const char *const body_start = (const char *)rawmemchr(buffer + STR_LEN("8=FIX.4.4\x01""9="), '\x01') + 1;
+
+  *parser = (ff_parser_t){
+    .state = FF_PARSER_BODY,
+    .checksum = 0,
+    .body_start = body_start - buffer,
+    .checksum_start = checksum_offset,
+    .checksummed = 0,
+    .tokenized = body_start - buffer,
+    .field_count = 0,
+    .max_fields = message->field_count
+  };
+
+  return true;
 }
 
-static bool tokenize(char *buffer, const char *const end, fix_message_t *const restrict message)
+//only touches the bytes received since the last call: the checksum is accumulated before the delimiters are overwritten
+static bool parse_body(ff_parser_t *restrict parser, char *restrict buffer, const uint16_t len, const fix_message_t *restrict message)
 {
-  fix_field_t *fields = message->fields;
-  const uint16_t max_fields = message->field_count;
+  const uint16_t limit = (len < parser->checksum_start) ? len : parser->checksum_start;
 
-  uint16_t field_count = 0;
-  while (LIKELY(buffer < end))
+  if (LIKELY(limit > parser->checksummed))
   {
-    char *delim = rawmemchr(buffer, '=');
-    const uint16_t tag_len = delim - buffer;
-    *delim++ = '\0';
-
-    char *soh = rawmemchr(delim, '\x01');
-    const uint16_t value_len = soh - delim;
-    *soh++ = '\0';
-
-    if (UNLIKELY(field_count++ >= max_fields))
-      return false;
-    
-    *fields++ = (fix_field_t){
-      .tag = buffer,
-      .value = delim,
-      .tag_len = tag_len,
-      .value_len = value_len
-    };
-
-    buffer = soh;
+    parser->checksum += compute_checksum(buffer + parser->checksummed, buffer + limit);
+    parser->checksummed = limit;
   }
-  message->field_count = field_count;
 
+  char *const fields_start = buffer + parser->tokenized;
+  const char *const last_soh = memrchr(fields_start, '\x01', limit - parser->tokenized);
+  if (!last_soh)
+    return true;
+
+  fix_message_t view = {
+    .fields = message->fields + parser->field_count,
+    .field_count = parser->max_fields - parser->field_count,
+    .flags = message->flags | (message->index ? FF_PARSE_TAGS : 0),
+    .index = NULL
+  };
+
+  if (UNLIKELY(!tokenize(fields_start, last_soh + 1, &view)))
+    return false;
+
+  parser->field_count += view.field_count;
+  parser->tokenized = last_soh + 1 - buffer;
   return true;
 }
 
-static uint32_t atoui(const char *str, const char **endptr)
+uint32_t atoui(const char *str, const char **endptr)
 {
   uint32_t result = 0;
 
@@ -290,9 +309,16 @@ static uint32_t atoui(const char *str, const char **endptr)
   return result;
 }
 
-static inline uint32_t mul10(uint32_t n)
-{
-  return (n << 3) + (n << 1);
-}
 
 
+//the tokenizer overwrites the '=' and the SOH of each field in turn, so the NULs alternate between the two
+static void restore_delimiters(char *buffer, const char *const end)
+{
+  char delimiter = '=';
+
+  while ((buffer = memchr(buffer, '\0', end - buffer)))
+  {
+    *buffer++ = delimiter;
+    delimiter ^= '=' ^ '\x01';
+  }
+}
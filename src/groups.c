@@ -0,0 +1,204 @@
+/*================================================================================
+
+File: groups.c                                                                  
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:54:42                                                 
+last edited: 2026-10-17 06:54:42                                                
+
+================================================================================*/
+
+#include "common.h"
+#include "groups.h"
+#include "serializer.h"
+
+static int32_t parse_group(const fix_message_t *restrict message, const ff_group_def_t *restrict def, uint16_t i, ff_groups_t *restrict groups, const uint16_t parent, const uint16_t parent_entry);
+static const ff_group_def_t *find_def(const ff_group_def_t *restrict defs, const uint8_t def_count, const uint32_t tag);
+static bool is_member(const ff_group_def_t *restrict def, const uint32_t tag);
+static inline uint32_t field_tag(const fix_message_t *restrict message, const uint16_t i);
+static char *write_groups(char *restrict buffer, const ff_group_data_t *restrict groups, const uint8_t group_count, uint64_t *restrict sum);
+static inline char *write_uint(char *restrict buffer, const uint32_t value, uint64_t *restrict sum);
+
+/*
+  one pass over the fields: every group of defs found in message is appended to groups->groups, nested ones after their parent.
+  groups->entries holds the index of the first field of every entry, the entries of a group are contiguous from first_entry.
+*/
+bool ff_get_groups(const fix_message_t *restrict message, const ff_group_def_t *restrict defs, const uint8_t def_count, ff_groups_t *restrict groups)
+{
+  groups->group_count = 0;
+  groups->entry_count = 0;
+
+  uint16_t i = 0;
+  while (LIKELY(i < message->field_count))
+  {
+    const ff_group_def_t *const def = find_def(defs, def_count, field_tag(message, i));
+    if (LIKELY(!def))
+    {
+      i++;
+      continue;
+    }
+
+    const int32_t next = parse_group(message, def, i, groups, FF_GROUP_NO_PARENT, 0);
+    if (UNLIKELY(next < 0))
+      return false;
+
+    i = next;
+  }
+
+  return true;
+}
+
+//message fields first, then every group with its entries, the count tags are written from entry_count
+char *ff_serialize_groups(char *restrict buffer, const fix_message_t *restrict message, const ff_group_data_t *restrict groups, const uint8_t group_count, uint16_t *restrict len)
+{
+  char *const body = buffer + FF_HEADER_RESERVED_LEN;
+
+  uint8_t fields_sum;
+  char *end = write_fields(body, message->fields, message->field_count, &fields_sum);
+
+  uint64_t sum = fields_sum;
+  end = write_groups(end, groups, group_count, &sum);
+
+  uint8_t checksum;
+  char *const start = prepend_header(body, end - body, &checksum);
+
+  *len = write_checksum(end, checksum + (uint8_t)sum) - start;
+  return start;
+}
+
+//i is the index of the count field, returns the index of the first field after the group or -1
+static int32_t parse_group(const fix_message_t *restrict message, const ff_group_def_t *restrict def, uint16_t i, ff_groups_t *restrict groups, const uint16_t parent, const uint16_t parent_entry)
+{
+  const fix_field_t *const count_field = &message->fields[i];
+  const uint32_t count = tag_to_uint(count_field->value, count_field->value_len);
+
+  if (UNLIKELY(count == UINT32_MAX || groups->group_count == groups->group_capacity))
+    return -1;
+
+  //the entries of a group are reserved up front, so the ones of nested groups come after them
+  if (UNLIKELY(count > (uint32_t)(groups->entry_capacity - groups->entry_count)))
+    return -1;
+
+  const uint16_t group_index = groups->group_count++;
+  uint16_t *const entries = &groups->entries[groups->entry_count];
+  ff_group_t *const group = &groups->groups[group_index];
+
+  *group = (ff_group_t){
+    .count_tag = def->count_tag,
+    .start = ++i,
+    .entry_count = 0,
+    .first_entry = groups->entry_count,
+    .parent = parent,
+    .parent_entry = parent_entry
+  };
+
+  groups->entry_count += count;
+
+  while (LIKELY(i < message->field_count && group->entry_count < count))
+  {
+    if (UNLIKELY(field_tag(message, i) != def->delimiter_tag))
+      break;
+
+    entries[group->entry_count++] = i++;
+
+    while (LIKELY(i < message->field_count))
+    {
+      const uint32_t tag = field_tag(message, i);
+      if (tag == def->delimiter_tag)
+        break;
+
+      const ff_group_def_t *const subgroup = find_def(def->subgroups, def->subgroup_count, tag);
+      if (subgroup)
+      {
+        const int32_t next = parse_group(message, subgroup, i, groups, group_index, group->entry_count - 1);
+        if (UNLIKELY(next < 0))
+          return -1;
+
+        i = next;
+        continue;
+      }
+
+      if (!is_member(def, tag))
+        break;
+
+      i++;
+    }
+  }
+
+  if (UNLIKELY(group->entry_count != count))
+    return -1;
+
+  group->end = i;
+  return i;
+}
+
+static const ff_group_def_t *find_def(const ff_group_def_t *restrict defs, const uint8_t def_count, const uint32_t tag)
+{
+  for (uint8_t i = 0; i < def_count; i++)
+  {
+    if (defs[i].count_tag == tag)
+      return &defs[i];
+  }
+
+  return NULL;
+}
+
+static bool is_member(const ff_group_def_t *restrict def, const uint32_t tag)
+{
+  for (uint8_t i = 0; i < def->member_count; i++)
+  {
+    if (def->member_tags[i] == tag)
+      return true;
+  }
+
+  return false;
+}
+
+//tag_num is only filled when the message was deserialized with FF_PARSE_TAGS
+static inline uint32_t field_tag(const fix_message_t *restrict message, const uint16_t i)
+{
+  const fix_field_t *const field = &message->fields[i];
+
+  if (LIKELY(message->flags & FF_PARSE_TAGS))
+    return field->tag_num;
+
+  return tag_to_uint(field->tag, field->tag_len);
+}
+
+static char *write_groups(char *restrict buffer, const ff_group_data_t *restrict groups, const uint8_t group_count, uint64_t *restrict sum)
+{
+  for (uint8_t i = 0; i < group_count; i++)
+  {
+    const ff_group_data_t *const group = &groups[i];
+
+    buffer = write_uint(buffer, group->count_tag, sum);
+    *buffer++ = '=';
+    buffer = write_uint(buffer, group->entry_count, sum);
+    *buffer++ = '\x01';
+    *sum += '=' + '\x01';
+
+    for (uint16_t j = 0; j < group->entry_count; j++)
+    {
+      const ff_entry_data_t *const entry = &group->entries[j];
+
+      uint8_t fields_sum;
+      buffer = write_fields(buffer, entry->fields, entry->field_count, &fields_sum);
+      *sum += fields_sum;
+
+      buffer = write_groups(buffer, entry->groups, entry->group_count, sum);
+    }
+  }
+
+  return buffer;
+}
+
+static inline char *write_uint(char *restrict buffer, const uint32_t value, uint64_t *restrict sum)
+{
+  const uint8_t len = ff_encode_uint(buffer, value);
+
+  for (uint8_t i = 0; i < len; i++)
+    *sum += buffer[i];
+
+  return buffer + len;
+}
\ No newline at end of file
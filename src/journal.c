@@ -0,0 +1,293 @@
+/*================================================================================
+
+File: journal.c                                                                 
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 07:24:23                                                 
+last edited: 2026-10-17 08:00:28                                                
+
+================================================================================*/
+
+#include "common.h"
+#include "journal.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define JOURNAL_MAGIC 0x31304c4e524a4646ULL
+#define HEADER_SIZE 4096
+
+static bool create_file(const int32_t fd, const uint32_t capacity, const uint64_t data_size);
+static inline size_t index_size(const uint32_t capacity);
+static uint32_t recover_count(const ff_journal_t *journal);
+static bool valid_entry(const char *message, const uint64_t len);
+static char *reserve(ff_journal_t *restrict journal, const uint32_t seq_num, const uint16_t len);
+static void commit(ff_journal_t *journal, const uint16_t len);
+static bool sync_range(const ff_journal_t *restrict journal, const char *restrict start, const char *restrict end, const int32_t flags);
+
+/*
+  file layout: a header page, the index, then the messages back to back.
+  index[i] is the offset in the data of message first_seq + i, index[count] the end of the last one, so a range of
+  messages is a single contiguous read. an existing journal is mapped as it is, capacity and data_size are only used to
+  create a new one: only the entries appended after the last durable sync are checked.
+*/
+bool ff_journal_open(ff_journal_t *restrict journal, const char *restrict path, const uint32_t capacity, const uint64_t data_size)
+{
+  *journal = (ff_journal_t){ .fd = -1 };
+
+  const int32_t fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (UNLIKELY(fd < 0))
+    return false;
+  journal->fd = fd;
+
+  struct stat st;
+  if (UNLIKELY(fstat(fd, &st) < 0))
+    goto fail;
+
+  ff_journal_header_t header;
+  const bool exists = (st.st_size >= HEADER_SIZE) && (pread(fd, &header, sizeof(header), 0) == sizeof(header)) && (header.magic == JOURNAL_MAGIC);
+  if (!exists)
+  {
+    if (UNLIKELY(!capacity || !create_file(fd, capacity, data_size)))
+      goto fail;
+    header = (ff_journal_header_t){ .capacity = capacity, .data_size = data_size };
+  }
+
+  journal->map_size = HEADER_SIZE + index_size(header.capacity) + header.data_size;
+  if (UNLIKELY(exists && (uint64_t)st.st_size < journal->map_size))
+    goto fail;
+
+  char *const map = mmap(NULL, journal->map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+  if (UNLIKELY(map == MAP_FAILED))
+    goto fail;
+
+  journal->map = map;
+  journal->header = (ff_journal_header_t *)map;
+  journal->index = (uint64_t *)(map + HEADER_SIZE);
+  journal->data = map + HEADER_SIZE + index_size(header.capacity);
+  journal->header->count = recover_count(journal);
+  journal->synced_count = journal->header->count;
+  return true;
+
+fail:
+  close(fd);
+  journal->fd = -1;
+  return false;
+}
+
+void ff_journal_close(ff_journal_t *journal)
+{
+  if (journal->map)
+    munmap(journal->map, journal->map_size);
+  if (journal->fd >= 0)
+    close(journal->fd);
+
+  *journal = (ff_journal_t){ .fd = -1 };
+}
+
+//for messages that are already serialized, e.g. by a template
+bool ff_journal_append(ff_journal_t *restrict journal, const uint32_t seq_num, const char *restrict message, const uint16_t len)
+{
+  char *const buffer = reserve(journal, seq_num, len);
+  if (UNLIKELY(!buffer))
+    return false;
+
+  memcpy(buffer, message, len);
+  commit(journal, len);
+  return true;
+}
+
+//serializes straight into the mapped file, the message is not copied
+bool ff_journal_append_message(ff_journal_t *restrict journal, const uint32_t seq_num, const fix_message_t *restrict message)
+{
+  const uint16_t body_length = compute_body_length(message->fields, message->field_count);
+  const uint32_t len = STR_LEN("8=FIX.4.4\x01""9=\x01") + count_digits(body_length) + body_length + STR_LEN("10=000\x01");
+  if (UNLIKELY(len > UINT16_MAX))
+    return false;
+
+  char *const buffer = reserve(journal, seq_num, len);
+  if (UNLIKELY(!buffer))
+    return false;
+
+  commit(journal, serialize_message(buffer, message, body_length));
+  return true;
+}
+
+/*
+  returns the messages from begin to end (0 for the last one) as one contiguous run, NULL if begin was never appended.
+  sequence numbers that were skipped on append take no bytes.
+*/
+const char *ff_journal_read(const ff_journal_t *restrict journal, const uint32_t begin, uint32_t end, uint64_t *restrict len)
+{
+  const ff_journal_header_t *const header = journal->header;
+  const uint32_t count = __atomic_load_n(&header->count, __ATOMIC_ACQUIRE);
+  const uint32_t last = header->first_seq + count - 1;
+
+  if (UNLIKELY(!count || begin < header->first_seq || begin > last))
+    return NULL;
+
+  if (end == 0 || end > last)
+    end = last;
+  if (UNLIKELY(end < begin))
+    return NULL;
+
+  const uint64_t start = journal->index[begin - header->first_seq];
+  *len = journal->index[end - header->first_seq + 1] - start;
+  return journal->data + start;
+}
+
+//after a restart, the sequence number to resume the session from
+uint32_t ff_journal_next_seq(const ff_journal_t *journal)
+{
+  const ff_journal_header_t *const header = journal->header;
+  return header->count ? header->first_seq + header->count : 0;
+}
+
+/*
+  writes the messages appended since the last call back to the file, meant to run off the hot path (e.g. from a timer
+  or another thread, while a single thread appends). without wait the writeback is only started.
+  the kernel can write the header page back at any time, so count alone proves nothing after a crash: durable_count is
+  only raised once MS_SYNC returned for the data and the index it covers.
+*/
+bool ff_journal_sync(ff_journal_t *journal, const bool wait)
+{
+  ff_journal_header_t *const header = journal->header;
+  const uint32_t count = __atomic_load_n(&header->count, __ATOMIC_ACQUIRE);
+  const uint32_t synced = wait ? header->durable_count : journal->synced_count;
+  if (count == synced)
+    return true;
+
+  const int32_t flags = wait ? MS_SYNC : MS_ASYNC;
+  const uint64_t *const index = journal->index;
+  bool valid = sync_range(journal, journal->data + index[synced], journal->data + index[count], flags);
+  valid &= sync_range(journal, (const char *)(index + synced), (const char *)(index + count + 1), flags);
+
+  if (wait && valid)
+  {
+    header->durable_count = count;
+    valid = sync_range(journal, journal->map, journal->map + sizeof(ff_journal_header_t), MS_SYNC);
+  }
+
+  journal->synced_count = valid ? count : journal->synced_count;
+  return valid;
+}
+
+//the file is preallocated, so appends never extend it
+static bool create_file(const int32_t fd, const uint32_t capacity, const uint64_t data_size)
+{
+  const ff_journal_header_t header = {
+    .magic = JOURNAL_MAGIC,
+    .data_size = data_size,
+    .capacity = capacity,
+    .first_seq = 0,
+    .count = 0,
+    .durable_count = 0
+  };
+
+  bool valid = posix_fallocate(fd, 0, HEADER_SIZE + index_size(capacity) + data_size) == 0;
+  valid = valid && pwrite(fd, &header, sizeof(header), 0) == sizeof(header);
+  return valid && fdatasync(fd) == 0;
+}
+
+//capacity + 1 offsets, rounded to a page so that the data starts page aligned
+static inline size_t index_size(const uint32_t capacity)
+{
+  return ((capacity + 1) * sizeof(uint64_t) + HEADER_SIZE - 1) & ~(size_t)(HEADER_SIZE - 1);
+}
+
+/*
+  the entries past durable_count may be on disk without their messages: they are kept up to the last whole message.
+  skipped sequence numbers are published with the message that follows them, so trailing empty entries are dropped too.
+*/
+static uint32_t recover_count(const ff_journal_t *journal)
+{
+  const ff_journal_header_t *const header = journal->header;
+  const uint32_t count = (header->count < header->capacity) ? header->count : header->capacity;
+  uint32_t recovered = (header->durable_count < count) ? header->durable_count : count;
+
+  for (uint32_t i = recovered; i < count; i++)
+  {
+    const uint64_t start = journal->index[i];
+    const uint64_t end = journal->index[i + 1];
+    if (UNLIKELY(end < start || end > header->data_size))
+      break;
+
+    if (end == start)
+      continue;
+
+    if (UNLIKELY(!valid_entry(journal->data + start, end - start)))
+      break;
+    recovered = i + 1;
+  }
+
+  return recovered;
+}
+
+//a message that was not written back is zeroed or stale, its begin string, trailer and checksum can't all match
+static bool valid_entry(const char *message, const uint64_t len)
+{
+  if (UNLIKELY(len < STR_LEN("8=FIX.4.4\x01""9=0\x01""10=000\x01") || len > UINT16_MAX))
+    return false;
+
+  const char *const trailer = message + len - STR_LEN("10=000\x01");
+  if (memcmp(message, "8=FIX", STR_LEN("8=FIX")) || !check_checksum_tag(trailer))
+    return false;
+
+  const char *checksum_end;
+  const uint32_t checksum = atoui(trailer + STR_LEN("10="), &checksum_end);
+  return (checksum_end == trailer + 6) && (checksum == compute_checksum(message, trailer));
+}
+
+/*
+  sequence numbers must grow: skipped ones get an empty entry, so the index stays dense.
+  returns where to write the message, NULL if it doesn't fit.
+*/
+static char *reserve(ff_journal_t *restrict journal, const uint32_t seq_num, const uint16_t len)
+{
+  ff_journal_header_t *const header = journal->header;
+  uint32_t count = header->count;
+
+  if (UNLIKELY(!count))
+  {
+    header->first_seq = seq_num;
+    journal->index[0] = 0;
+  }
+
+  const uint32_t expected = header->first_seq + count;
+  if (UNLIKELY(seq_num < expected || seq_num - header->first_seq >= header->capacity))
+    return NULL;
+
+  const uint64_t end = journal->index[count];
+  if (UNLIKELY(end + len > header->data_size))
+    return NULL;
+
+  //the empty entries are published with the message
+  for (; count < seq_num - header->first_seq; count++)
+    journal->index[count + 1] = end;
+  __atomic_store_n(&header->count, count, __ATOMIC_RELEASE);
+
+  return journal->data + end;
+}
+
+static void commit(ff_journal_t *journal, const uint16_t len)
+{
+  ff_journal_header_t *const header = journal->header;
+  const uint32_t count = header->count;
+
+  journal->index[count + 1] = journal->index[count] + len;
+  __atomic_store_n(&header->count, count + 1, __ATOMIC_RELEASE);
+}
+
+//msync works on whole pages
+static bool sync_range(const ff_journal_t *restrict journal, const char *restrict start, const char *restrict end, const int32_t flags)
+{
+  const uintptr_t page_mask = HEADER_SIZE - 1;
+  char *const page_start = (char *)((uintptr_t)start & ~page_mask);
+  const char *const map_end = journal->map + journal->map_size;
+  const char *const page_end = (char *)(((uintptr_t)end + page_mask) & ~page_mask);
+
+  return msync(page_start, ((page_end < map_end) ? page_end : map_end) - page_start, flags) == 0;
+}
@@ -0,0 +1,133 @@
+/*================================================================================
+
+File: body_length.c                                                             
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:26:12                                                 
+last edited: 2026-10-17 07:07:11                                                
+
+================================================================================*/
+
+#include "kernels.h"
+
+uint16_t KERNEL(compute_body_length)(const fix_field_t *fields, uint16_t field_count)
+{
+  uint16_t total_len = (field_count << 1);
+
+#ifdef __AVX512F__
+  const __m512i len_offsets = _mm512_mullo_epi32(_mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), _mm512_set1_epi32(sizeof(fix_field_t)));
+  const __m512i mask_lower_16 = _mm512_set1_epi32(0x0000FFFF);
+
+  while (LIKELY(field_count >= 16))
+  {
+    const __m512i lengths = _mm512_i32gather_epi32(len_offsets, fields, 1);
+
+    const __m512i tag_len = _mm512_and_si512(lengths, mask_lower_16);
+    const __m512i value_len = _mm512_srli_epi32(lengths, 16);
+
+    const __m512i sum = _mm512_add_epi32(tag_len, value_len);
+    total_len += _mm512_reduce_add_epi32(sum);
+
+    field_count -= 16;
+    fields += 16;
+  }
+#endif
+
+//TODO: Implement AVX2 and SSE2 versions (they dont have reduce, so we need to use _mm256_extract_epi32 and _mm_extract_epi32)
+
+  while (LIKELY(field_count--))
+  {
+    total_len += fields->tag_len + fields->value_len;
+    fields++;
+  }
+
+  return total_len;
+}
+
+//the tag ends right before its value, so each field is values[i] - tags[i] + value_lens[i] bytes plus the SOH
+uint16_t KERNEL(compact_body_length)(const fix_compact_message_t *message)
+{
+  const uint16_t *tags = message->tags;
+  const uint16_t *values = message->values;
+  const uint16_t *value_lens = message->value_lens;
+  uint16_t field_count = message->field_count;
+
+  uint32_t total_len = field_count;
+
+#if defined(__AVX512BW__)
+  const __m512i vec_zeros_512 = _mm512_setzero_si512();
+  __m512i acc = vec_zeros_512;
+
+  while (LIKELY(field_count >= 32))
+  {
+    const __m512i tag_offsets = _mm512_loadu_si512((const __m512i *)tags);
+    const __m512i value_offsets = _mm512_loadu_si512((const __m512i *)values);
+    const __m512i lens = _mm512_loadu_si512((const __m512i *)value_lens);
+
+    //per field lengths fit 16 bits, they are widened before being summed
+    const __m512i field_lens = _mm512_add_epi16(_mm512_sub_epi16(value_offsets, tag_offsets), lens);
+    acc = _mm512_add_epi32(acc, _mm512_unpacklo_epi16(field_lens, vec_zeros_512));
+    acc = _mm512_add_epi32(acc, _mm512_unpackhi_epi16(field_lens, vec_zeros_512));
+
+    tags += 32;
+    values += 32;
+    value_lens += 32;
+    field_count -= 32;
+  }
+
+  total_len += _mm512_reduce_add_epi32(acc);
+#elif defined(__AVX2__)
+  const __m256i vec_zeros_256 = _mm256_setzero_si256();
+  __m256i acc = vec_zeros_256;
+
+  while (LIKELY(field_count >= 16))
+  {
+    const __m256i tag_offsets = _mm256_loadu_si256((const __m256i *)tags);
+    const __m256i value_offsets = _mm256_loadu_si256((const __m256i *)values);
+    const __m256i lens = _mm256_loadu_si256((const __m256i *)value_lens);
+
+    const __m256i field_lens = _mm256_add_epi16(_mm256_sub_epi16(value_offsets, tag_offsets), lens);
+    acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(field_lens, vec_zeros_256));
+    acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(field_lens, vec_zeros_256));
+
+    tags += 16;
+    values += 16;
+    value_lens += 16;
+    field_count -= 16;
+  }
+
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  total_len += _mm_cvtsi128_si32(sum);
+#elif defined(__SSE2__)
+  const __m128i vec_zeros_128 = _mm_setzero_si128();
+  __m128i acc = vec_zeros_128;
+
+  while (LIKELY(field_count >= 8))
+  {
+    const __m128i tag_offsets = _mm_loadu_si128((const __m128i *)tags);
+    const __m128i value_offsets = _mm_loadu_si128((const __m128i *)values);
+    const __m128i lens = _mm_loadu_si128((const __m128i *)value_lens);
+
+    const __m128i field_lens = _mm_add_epi16(_mm_sub_epi16(value_offsets, tag_offsets), lens);
+    acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(field_lens, vec_zeros_128));
+    acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(field_lens, vec_zeros_128));
+
+    tags += 8;
+    values += 8;
+    value_lens += 8;
+    field_count -= 8;
+  }
+
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  total_len += _mm_cvtsi128_si32(acc);
+#endif
+
+  while (LIKELY(field_count--))
+    total_len += (uint16_t)(*values++ - *tags++ + *value_lens++);
+
+  return total_len;
+}
\ No newline at end of file
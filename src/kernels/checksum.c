@@ -0,0 +1,189 @@
+/*================================================================================
+
+File: checksum.c                                                                
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:26:12                                                 
+last edited: 2026-10-17 06:26:12                                                
+
+================================================================================*/
+
+#include "kernels.h"
+
+uint8_t KERNEL(compute_checksum)(const char *buffer, const char *const end)
+{
+#ifdef __AVX512F__
+  const __m512i vec_zeros_512 = _mm512_setzero_si512();
+#endif
+#ifdef __AVX2__
+  const __m256i vec_zeros_256 = _mm256_setzero_si256();
+#endif
+#ifdef __SSE4_1__
+  const __m128i vec_zeros_128 = _mm_setzero_si128();
+#endif
+
+  uint16_t remaining = end - buffer;
+  
+  uint8_t misaligned_bytes = align_forward(buffer);
+  misaligned_bytes -= (misaligned_bytes > remaining) * (misaligned_bytes - remaining);
+
+  uint8_t checksum = 0;
+
+  while (UNLIKELY(misaligned_bytes--))
+  {
+    checksum += *buffer++;
+    remaining--;
+  }
+
+#ifdef __AVX512F__
+  while (LIKELY(remaining >= 64))
+  {
+    const __m512i vec = _mm512_load_si512((const __m512i *)buffer);
+    const __m512i sum = _mm512_sad_epu8(vec, vec_zeros_512);
+    checksum += (uint8_t)_mm512_reduce_add_epi64(sum);
+
+    buffer += 64;
+    remaining -= 64;
+  }
+#endif
+
+#ifdef __AVX2__
+  while (LIKELY(remaining >= 32))
+  {
+    const __m256i vec = _mm256_load_si256((const __m256i *)buffer);
+    const __m256i sum = _mm256_sad_epu8(vec, vec_zeros_256);
+    
+    const __m128i sum_low = _mm256_extracti128_si256(sum, 0);
+    const __m128i sum_high = _mm256_extracti128_si256(sum, 1);
+    const __m128i sum_total = _mm_add_epi64(sum_low, sum_high);
+
+    checksum += (uint8_t)(_mm_extract_epi64(sum_total, 0) + _mm_extract_epi64(sum_total, 1));
+
+    buffer += 32;
+    remaining -= 32;
+  }
+#endif
+
+#ifdef __SSE4_1__
+  while (LIKELY(remaining >= 16))
+  {
+    const __m128i vec = _mm_load_si128((const __m128i *)buffer);
+    const __m128i sum = _mm_sad_epu8(vec, vec_zeros_128);
+
+    checksum += (uint8_t)(_mm_extract_epi64(sum, 0) + _mm_extract_epi64(sum, 1));
+
+    buffer += 16;
+    remaining -= 16;
+  }
+#endif
+
+  while (LIKELY(remaining >= 8))
+  {
+    uint64_t chunk = *(const uint64_t *)buffer;
+
+    chunk = (chunk & 0x00FF00FF00FF00FFULL) + ((chunk >> 8) & 0x00FF00FF00FF00FFULL);
+    chunk = (chunk & 0x0000FFFF0000FFFFULL) + ((chunk >> 16) & 0x0000FFFF0000FFFFULL);
+    chunk = (chunk & 0x00000000FFFFFFFFULL) + (chunk >> 32);
+
+    checksum += (uint8_t)chunk;
+    
+    buffer += 8;
+    remaining -= 8;
+  }
+
+  while (LIKELY(remaining--))
+    checksum += *buffer++;
+
+  return checksum;
+}
+
+//independent accumulators for CHECKSUM_LANES messages, reduced once at the end
+void KERNEL(compute_checksums)(const char *const *buffers, const char *const *ends, uint8_t *checksums)
+{
+#ifdef __AVX512BW__
+  const __m512i vec_zeros_512 = _mm512_setzero_si512();
+#endif
+#ifdef __AVX2__
+  const __m256i vec_zeros_256 = _mm256_setzero_si256();
+#endif
+#ifdef __SSE2__
+  const __m128i vec_zeros_128 = _mm_setzero_si128();
+#endif
+
+  uint16_t common_len = UINT16_MAX;
+  for (uint8_t i = 0; i < CHECKSUM_LANES; i++)
+  {
+    const uint16_t len = ends[i] - buffers[i];
+    common_len = (len < common_len) ? len : common_len;
+  }
+
+  uint64_t sums[CHECKSUM_LANES] = {0};
+  uint16_t offset = 0;
+
+#ifdef __AVX512BW__
+  __m512i acc_512[CHECKSUM_LANES];
+  for (uint8_t i = 0; i < CHECKSUM_LANES; i++)
+    acc_512[i] = vec_zeros_512;
+
+  while (LIKELY(common_len - offset >= 64))
+  {
+    for (uint8_t i = 0; i < CHECKSUM_LANES; i++)
+    {
+      const __m512i vec = _mm512_loadu_si512((const __m512i *)(buffers[i] + offset));
+      acc_512[i] = _mm512_add_epi64(acc_512[i], _mm512_sad_epu8(vec, vec_zeros_512));
+    }
+
+    offset += 64;
+  }
+
+  for (uint8_t i = 0; i < CHECKSUM_LANES; i++)
+    sums[i] += _mm512_reduce_add_epi64(acc_512[i]);
+#endif
+
+#ifdef __AVX2__
+  __m256i acc_256[CHECKSUM_LANES];
+  for (uint8_t i = 0; i < CHECKSUM_LANES; i++)
+    acc_256[i] = vec_zeros_256;
+
+  while (LIKELY(common_len - offset >= 32))
+  {
+    for (uint8_t i = 0; i < CHECKSUM_LANES; i++)
+    {
+      const __m256i vec = _mm256_loadu_si256((const __m256i *)(buffers[i] + offset));
+      acc_256[i] = _mm256_add_epi64(acc_256[i], _mm256_sad_epu8(vec, vec_zeros_256));
+    }
+
+    offset += 32;
+  }
+
+  for (uint8_t i = 0; i < CHECKSUM_LANES; i++)
+  {
+    const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(acc_256[i]), _mm256_extracti128_si256(acc_256[i], 1));
+    sums[i] += _mm_cvtsi128_si64(sum) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(sum, sum));
+  }
+#endif
+
+#ifdef __SSE2__
+  __m128i acc_128[CHECKSUM_LANES];
+  for (uint8_t i = 0; i < CHECKSUM_LANES; i++)
+    acc_128[i] = vec_zeros_128;
+
+  while (LIKELY(common_len - offset >= 16))
+  {
+    for (uint8_t i = 0; i < CHECKSUM_LANES; i++)
+    {
+      const __m128i vec = _mm_loadu_si128((const __m128i *)(buffers[i] + offset));
+      acc_128[i] = _mm_add_epi64(acc_128[i], _mm_sad_epu8(vec, vec_zeros_128));
+    }
+
+    offset += 16;
+  }
+
+  for (uint8_t i = 0; i < CHECKSUM_LANES; i++)
+    sums[i] += _mm_cvtsi128_si64(acc_128[i]) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(acc_128[i], acc_128[i]));
+#endif
+
+  for (uint8_t i = 0; i < CHECKSUM_LANES; i++)
+    checksums[i] = (uint8_t)sums[i] + KERNEL(compute_checksum)(buffers[i] + offset, ends[i]);
+}
\ No newline at end of file
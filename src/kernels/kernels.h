@@ -0,0 +1,41 @@
+/*================================================================================
+
+File: kernels.h                                                                 
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:27:48                                                 
+last edited: 2026-10-17 07:07:11                                                
+
+================================================================================*/
+
+#ifndef KERNELS_H
+# define KERNELS_H
+
+# include "common.h"
+
+# ifndef ISA
+#   error "kernels must be compiled with -DISA=<tier>"
+# endif
+
+# define KERNEL(name)               KERNEL_NAME(name, ISA)
+# define KERNEL_NAME(name, isa)     KERNEL_PASTE(name, isa)
+# define KERNEL_PASTE(name, isa)    name##_##isa
+# define KERNEL_STRING(isa)         KERNEL_QUOTE(isa)
+# define KERNEL_QUOTE(isa)          #isa
+
+INTERNAL uint8_t KERNEL(compute_checksum)(const char *buffer, const char *const end);
+INTERNAL void KERNEL(compute_checksums)(const char *const *buffers, const char *const *ends, uint8_t *checksums);
+INTERNAL const char *KERNEL(get_checksum_start)(const char *buffer, const uint16_t buffer_size);
+INTERNAL const char *KERNEL(find_begin_string)(const char *buffer, const char *const end);
+INTERNAL bool KERNEL(tokenize)(char *buffer, const char *const end, fix_message_t *const restrict message);
+INTERNAL bool KERNEL(scan_message)(char *buffer, char *body_start, const char *checksum_start, fix_message_t *const restrict message, uint8_t *restrict checksum);
+INTERNAL bool KERNEL(scan_fields)(char *buffer, char *body_start, const char *checksum_start, field_visitor_t visitor, void *context, uint8_t *restrict checksum);
+INTERNAL bool KERNEL(scan_compact)(char *buffer, char *body_start, const char *checksum_start, fix_compact_message_t *const restrict message, uint8_t *restrict checksum);
+INTERNAL uint16_t KERNEL(compute_body_length)(const fix_field_t *fields, uint16_t field_count);
+INTERNAL uint16_t KERNEL(compact_body_length)(const fix_compact_message_t *message);
+INTERNAL bool KERNEL(parse_timestamp)(const char *restrict timestamp, timestamp_t *restrict parts);
+INTERNAL char *KERNEL(write_fields)(char *restrict buffer, const fix_field_t *restrict fields, uint16_t field_count, uint8_t *restrict checksum);
+INTERNAL char *KERNEL(write_compact_fields)(char *restrict buffer, const fix_compact_message_t *restrict message, uint8_t *restrict checksum);
+
+#endif
\ No newline at end of file
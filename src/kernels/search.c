@@ -0,0 +1,247 @@
+/*================================================================================
+
+File: search.c                                                                  
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:26:12                                                 
+last edited: 2026-10-17 08:37:27                                                
+
+================================================================================*/
+
+#include "kernels.h"
+
+//only used as a fallback when the header can't be trusted for framing
+const char *KERNEL(get_checksum_start)(const char *buffer, const uint16_t buffer_size)
+{
+#ifdef __AVX512BW__
+  const __m512i vec_ones_512 = _mm512_set1_epi8('1');
+#endif
+#ifdef __AVX2__
+  const __m256i vec_ones_256 = _mm256_set1_epi8('1');
+#endif
+#ifdef __SSE2__
+  const __m128i vec_ones_128 = _mm_set1_epi8('1');
+#endif
+
+  int32_t remaining = buffer_size - STR_LEN("10=000\x01") + 1;
+  if (UNLIKELY(remaining <= 0))
+    return NULL;
+
+  uint8_t misaligned_bytes = align_forward(buffer);
+  misaligned_bytes -= (misaligned_bytes > remaining) * (misaligned_bytes - remaining);
+
+  while (UNLIKELY(misaligned_bytes--))
+  {
+    bool found = buffer[0] == '1';
+    found &= check_zero_equal_soh(buffer + 1);
+
+    if (UNLIKELY(found))
+      return buffer;
+
+    buffer++;
+    remaining--;
+  }
+
+#ifdef __AVX512BW__
+  while (LIKELY(remaining >= 64))
+  {
+    const __m512i chunk = _mm512_load_si512((__m512i*)buffer);
+    __mmask64 mask = _mm512_cmpeq_epi8_mask(chunk, vec_ones_512);
+
+    while (UNLIKELY(mask))
+    {
+      const int32_t offset = __builtin_ctzll(mask);
+      const char *const candidate = buffer + offset;
+
+      if (UNLIKELY(check_zero_equal_soh(candidate + 1)))
+        return candidate;
+
+      mask &= mask - 1;
+    }
+
+    buffer += 64;
+    remaining -= 64;
+  }
+#endif
+
+#ifdef __AVX2__
+  while (LIKELY(remaining >= 32))
+  {
+    const __m256i chunk = _mm256_load_si256((__m256i *)buffer);
+    const __m256i cmp = _mm256_cmpeq_epi8(chunk, vec_ones_256);
+    uint32_t mask = _mm256_movemask_epi8(cmp);
+
+    while (UNLIKELY(mask))
+    {
+      const int32_t offset = __builtin_ctz(mask); //TODO stdc_trailing_zeros(mask);
+      const char *const candidate = buffer + offset;
+
+      if (UNLIKELY(check_zero_equal_soh(candidate + 1)))
+        return candidate;
+
+      mask &= mask - 1;
+    }
+
+    buffer += 32;
+    remaining -= 32;
+  }
+#endif
+
+#ifdef __SSE2__
+  while (LIKELY(remaining >= 16))
+  {
+    const __m128i chunk = _mm_load_si128((__m128i *)buffer);
+    const __m128i cmp = _mm_cmpeq_epi8(chunk, vec_ones_128);
+    uint32_t mask = _mm_movemask_epi8(cmp);
+
+    while (UNLIKELY(mask))
+    {
+      const int32_t offset = __builtin_ctz(mask); //TODO stdc_trailing_zeros(mask);
+      const char *const candidate = buffer + offset;
+
+      if (UNLIKELY(check_zero_equal_soh(candidate + 1)))
+        return candidate;
+
+      mask &= mask - 1;
+    }
+
+    buffer += 16;
+    remaining -= 16;
+  }
+#endif
+
+  while (LIKELY(remaining >= 8))
+  {
+    const uint64_t chunk = *(const uint64_t *)buffer;
+    const uint64_t cmp = chunk ^ 0x3131313131313131ULL;
+    uint64_t mask = (cmp - 0x0101010101010101ULL) & ~cmp & 0x8080808080808080ULL;
+
+    while (UNLIKELY(mask))
+    {
+      const int32_t byte_offset = __builtin_ctzll(mask) >> 3; //TODO stdc_trailing_zeros(mask) >> 3;
+      const char *const candidate = buffer + byte_offset;
+
+      if (UNLIKELY(check_zero_equal_soh(candidate + 1)))
+        return candidate;
+
+      mask &= mask - 1;
+    }
+
+    buffer += 8;
+    remaining -= 8;
+  }
+
+  while (LIKELY(remaining--))
+  {
+    bool found = (buffer[0] == '1') & check_zero_equal_soh(buffer + 1);
+
+    if (UNLIKELY(found))
+      return buffer;
+
+    buffer++;
+  }
+
+  return NULL;
+}
+
+//finds the next "8=FIX" candidate, matching '8' and '=' on two overlapping loads
+const char *KERNEL(find_begin_string)(const char *buffer, const char *const end)
+{
+#ifdef __AVX512BW__
+  const __m512i vec_eight_512 = _mm512_set1_epi8('8');
+  const __m512i vec_equals_512 = _mm512_set1_epi8('=');
+#endif
+#ifdef __AVX2__
+  const __m256i vec_eight_256 = _mm256_set1_epi8('8');
+  const __m256i vec_equals_256 = _mm256_set1_epi8('=');
+#endif
+#ifdef __SSE2__
+  const __m128i vec_eight_128 = _mm_set1_epi8('8');
+  const __m128i vec_equals_128 = _mm_set1_epi8('=');
+#endif
+
+  int32_t remaining = end - buffer - STR_LEN("8=FIX") + 1;
+  if (UNLIKELY(remaining <= 0))
+    return NULL;
+
+#ifdef __AVX512BW__
+  while (LIKELY(remaining >= 64))
+  {
+    const __m512i chunk = _mm512_loadu_si512((const __m512i *)buffer);
+    const __m512i next = _mm512_loadu_si512((const __m512i *)(buffer + 1));
+    __mmask64 mask = _mm512_cmpeq_epi8_mask(chunk, vec_eight_512) & _mm512_cmpeq_epi8_mask(next, vec_equals_512);
+
+    while (UNLIKELY(mask))
+    {
+      const char *const candidate = buffer + __builtin_ctzll(mask);
+
+      if (LIKELY(memcmp4(candidate + 1, "=FIX")))
+        return candidate;
+
+      mask &= mask - 1;
+    }
+
+    buffer += 64;
+    remaining -= 64;
+  }
+#endif
+
+#ifdef __AVX2__
+  while (LIKELY(remaining >= 32))
+  {
+    const __m256i chunk = _mm256_loadu_si256((const __m256i *)buffer);
+    const __m256i next = _mm256_loadu_si256((const __m256i *)(buffer + 1));
+    const __m256i cmp = _mm256_and_si256(_mm256_cmpeq_epi8(chunk, vec_eight_256), _mm256_cmpeq_epi8(next, vec_equals_256));
+    uint32_t mask = _mm256_movemask_epi8(cmp);
+
+    while (UNLIKELY(mask))
+    {
+      const char *const candidate = buffer + __builtin_ctz(mask);
+
+      if (LIKELY(memcmp4(candidate + 1, "=FIX")))
+        return candidate;
+
+      mask &= mask - 1;
+    }
+
+    buffer += 32;
+    remaining -= 32;
+  }
+#endif
+
+#ifdef __SSE2__
+  while (LIKELY(remaining >= 16))
+  {
+    const __m128i chunk = _mm_loadu_si128((const __m128i *)buffer);
+    const __m128i next = _mm_loadu_si128((const __m128i *)(buffer + 1));
+    const __m128i cmp = _mm_and_si128(_mm_cmpeq_epi8(chunk, vec_eight_128), _mm_cmpeq_epi8(next, vec_equals_128));
+    uint32_t mask = _mm_movemask_epi8(cmp);
+
+    while (UNLIKELY(mask))
+    {
+      const char *const candidate = buffer + __builtin_ctz(mask);
+
+      if (LIKELY(memcmp4(candidate + 1, "=FIX")))
+        return candidate;
+
+      mask &= mask - 1;
+    }
+
+    buffer += 16;
+    remaining -= 16;
+  }
+#endif
+
+  while (LIKELY(remaining--))
+  {
+    const bool found = (buffer[0] == '8') & memcmp4(buffer + 1, "=FIX");
+
+    if (UNLIKELY(found))
+      return buffer;
+
+    buffer++;
+  }
+
+  return NULL;
+}
\ No newline at end of file
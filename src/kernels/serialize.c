@@ -0,0 +1,209 @@
+/*================================================================================
+
+File: serialize.c                                                               
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:44:25                                                 
+last edited: 2026-10-17 08:34:56                                                
+
+================================================================================*/
+
+#include "kernels.h"
+
+#include <string.h>
+
+#if defined(__AVX512BW__)
+typedef __m512i sum_t;
+#elif defined(__SSE2__)
+typedef __m128i sum_t;
+#else
+typedef uint64_t sum_t;
+#endif
+
+static ALWAYS_INLINE inline sum_t copy_and_sum(char *restrict dest, const char *restrict src, uint16_t len, sum_t acc);
+static ALWAYS_INLINE inline sum_t sum_zero(void);
+static ALWAYS_INLINE inline uint64_t sum_reduce(const sum_t acc);
+#if defined(__SSE2__) && !defined(__AVX512BW__)
+static ALWAYS_INLINE inline __m128i load_tail(const char *src, const uint8_t len);
+#endif
+
+//writes "tag=value\x01" for every field, summing the bytes as they are stored instead of reading the output again
+char *KERNEL(write_fields)(char *restrict buffer, const fix_field_t *restrict fields, uint16_t field_count, uint8_t *restrict checksum)
+{
+  //the delimiters are known, only tags and values are summed
+  const uint64_t delimiters_sum = (uint64_t)field_count * ('=' + '\x01');
+  sum_t acc = sum_zero();
+
+  for (uint16_t i = 0; LIKELY(i < field_count); i++)
+  {
+    acc = copy_and_sum(buffer, fields[i].tag, fields[i].tag_len, acc);
+    buffer += fields[i].tag_len;
+    *buffer++ = '=';
+
+    acc = copy_and_sum(buffer, fields[i].value, fields[i].value_len, acc);
+    buffer += fields[i].value_len;
+    *buffer++ = '\x01';
+  }
+
+  *checksum = (uint8_t)(delimiters_sum + sum_reduce(acc));
+  return buffer;
+}
+
+//"tag=value" is contiguous in the source buffer, so each field is a single copy
+char *KERNEL(write_compact_fields)(char *restrict buffer, const fix_compact_message_t *restrict message, uint8_t *restrict checksum)
+{
+  const uint64_t delimiters_sum = (uint64_t)message->field_count * '\x01';
+  sum_t acc = sum_zero();
+
+  for (uint16_t i = 0; LIKELY(i < message->field_count); i++)
+  {
+    const uint16_t len = message->values[i] - message->tags[i] + message->value_lens[i];
+
+    acc = copy_and_sum(buffer, message->buffer + message->tags[i], len, acc);
+    buffer += len;
+    *buffer++ = '\x01';
+  }
+
+  *checksum = (uint8_t)(delimiters_sum + sum_reduce(acc));
+  return buffer;
+}
+
+#if defined(__AVX512BW__)
+
+static ALWAYS_INLINE inline sum_t copy_and_sum(char *restrict dest, const char *restrict src, uint16_t len, sum_t acc)
+{
+  const __m512i vec_zeros_512 = _mm512_setzero_si512();
+
+  while (UNLIKELY(len >= 64))
+  {
+    const __m512i vec = _mm512_loadu_si512((const __m512i *)src);
+    _mm512_storeu_si512((__m512i *)dest, vec);
+    acc = _mm512_add_epi64(acc, _mm512_sad_epu8(vec, vec_zeros_512));
+
+    src += 64;
+    dest += 64;
+    len -= 64;
+  }
+
+  //masked loads don't fault past the end of the source, the masked out bytes are zero and don't change the sum
+  const __mmask64 mask = _bzhi_u64(UINT64_MAX, len);
+  const __m512i vec = _mm512_maskz_loadu_epi8(mask, src);
+  _mm512_mask_storeu_epi8(dest, mask, vec);
+  return _mm512_add_epi64(acc, _mm512_sad_epu8(vec, vec_zeros_512));
+}
+
+static ALWAYS_INLINE inline sum_t sum_zero(void)
+{
+  return _mm512_setzero_si512();
+}
+
+static ALWAYS_INLINE inline uint64_t sum_reduce(const sum_t acc)
+{
+  return _mm512_reduce_add_epi64(acc);
+}
+
+#elif defined(__SSE2__)
+
+static ALWAYS_INLINE inline sum_t copy_and_sum(char *restrict dest, const char *restrict src, uint16_t len, sum_t acc)
+{
+  const __m128i vec_zeros_128 = _mm_setzero_si128();
+
+# ifdef __AVX2__
+  if (UNLIKELY(len >= 32))
+  {
+    const __m256i vec_zeros_256 = _mm256_setzero_si256();
+    __m256i acc_256 = vec_zeros_256;
+
+    do
+    {
+      const __m256i vec = _mm256_loadu_si256((const __m256i *)src);
+      _mm256_storeu_si256((__m256i *)dest, vec);
+      acc_256 = _mm256_add_epi64(acc_256, _mm256_sad_epu8(vec, vec_zeros_256));
+
+      src += 32;
+      dest += 32;
+      len -= 32;
+    } while (LIKELY(len >= 32));
+
+    acc = _mm_add_epi64(acc, _mm_add_epi64(_mm256_castsi256_si128(acc_256), _mm256_extracti128_si256(acc_256, 1)));
+  }
+# endif
+
+  while (UNLIKELY(len >= 16))
+  {
+    const __m128i vec = _mm_loadu_si128((const __m128i *)src);
+    _mm_storeu_si128((__m128i *)dest, vec);
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(vec, vec_zeros_128));
+
+    src += 16;
+    dest += 16;
+    len -= 16;
+  }
+
+  //src is past the end of the value, it may be the first byte of an unmapped page
+  if (UNLIKELY(len == 0))
+    return acc;
+
+  //tags and most values are shorter than 16 bytes: one zero extended load for the sum, exact overlapping stores for the copy
+  const __m128i vec = load_tail(src, len);
+  acc = _mm_add_epi64(acc, _mm_sad_epu8(vec, vec_zeros_128));
+
+  if (LIKELY(len >= 8))
+  {
+    memcpy8(dest, src);
+    memcpy8(dest + len - 8, src + len - 8);
+  }
+  else if (LIKELY(len >= 4))
+  {
+    memcpy4(dest, src);
+    memcpy4(dest + len - 4, src + len - 4);
+  }
+  else
+  {
+    for (uint8_t i = 0; i < len; i++)
+      dest[i] = src[i];
+  }
+
+  return acc;
+}
+
+static ALWAYS_INLINE inline sum_t sum_zero(void)
+{
+  return _mm_setzero_si128();
+}
+
+static ALWAYS_INLINE inline uint64_t sum_reduce(const sum_t acc)
+{
+  return _mm_cvtsi128_si64(acc) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc));
+}
+
+//the first len bytes of src, zero extended: they are staged on the stack, the bytes after them belong to the next field or to another allocation
+static ALWAYS_INLINE inline __m128i load_tail(const char *src, const uint8_t len)
+{
+  char tail[16] ALIGNED(16) = {0};
+  memcpy(tail, src, len);
+  return _mm_load_si128((const __m128i *)tail);
+}
+
+#else
+
+static ALWAYS_INLINE inline sum_t copy_and_sum(char *restrict dest, const char *restrict src, uint16_t len, sum_t acc)
+{
+  for (uint16_t i = 0; i < len; i++)
+    acc += (uint8_t)(dest[i] = src[i]);
+
+  return acc;
+}
+
+static ALWAYS_INLINE inline sum_t sum_zero(void)
+{
+  return 0;
+}
+
+static ALWAYS_INLINE inline uint64_t sum_reduce(const sum_t acc)
+{
+  return acc;
+}
+
+#endif
\ No newline at end of file
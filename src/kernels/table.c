@@ -0,0 +1,29 @@
+/*================================================================================
+
+File: table.c                                                                   
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:26:12                                                 
+last edited: 2026-10-17 07:07:11                                                
+
+================================================================================*/
+
+#include "kernels.h"
+
+const kernels_t KERNEL(kernels) = {
+  .name = KERNEL_STRING(ISA),
+  .compute_checksum = KERNEL(compute_checksum),
+  .compute_checksums = KERNEL(compute_checksums),
+  .get_checksum_start = KERNEL(get_checksum_start),
+  .find_begin_string = KERNEL(find_begin_string),
+  .tokenize = KERNEL(tokenize),
+  .scan_message = KERNEL(scan_message),
+  .scan_fields = KERNEL(scan_fields),
+  .scan_compact = KERNEL(scan_compact),
+  .compute_body_length = KERNEL(compute_body_length),
+  .compact_body_length = KERNEL(compact_body_length),
+  .parse_timestamp = KERNEL(parse_timestamp),
+  .write_fields = KERNEL(write_fields),
+  .write_compact_fields = KERNEL(write_compact_fields)
+};
\ No newline at end of file
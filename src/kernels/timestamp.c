@@ -0,0 +1,116 @@
+/*================================================================================
+
+File: timestamp.c                                                               
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:36:04                                                 
+last edited: 2026-10-17 06:36:04                                                
+
+================================================================================*/
+
+#include "kernels.h"
+
+UNUSED static inline uint8_t pair(const char *digits);
+
+/*
+  timestamp is TIMESTAMP_SIZE bytes laid out as "YYYYMMDD-HH:MM:SS.sssssssss", padded with '0'.
+  the layout is validated with a single compare per vector, then the digits are gathered in pairs
+  and every pair is converted at once with a multiply-add.
+*/
+bool KERNEL(parse_timestamp)(const char *restrict timestamp, timestamp_t *restrict parts)
+{
+#if defined(__AVX2__)
+  const __m256i layout = _mm256_setr_epi8(
+    '0', '0', '0', '0', '0', '0', '0', '0', '-', '0', '0', ':', '0', '0', ':', '0',
+    '0', '.', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0');
+  const __m256i chunk = _mm256_load_si256((const __m256i *)timestamp);
+  const __m256i digits = _mm256_sub_epi8(chunk, _mm256_set1_epi8('0'));
+  const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digits, _mm256_set1_epi8(9)), digits);
+  const __m256i is_layout = _mm256_cmpeq_epi8(chunk, layout);
+  const __m256i digit_lanes = _mm256_cmpeq_epi8(layout, _mm256_set1_epi8('0'));
+
+  if (UNLIKELY((uint32_t)_mm256_movemask_epi8(_mm256_blendv_epi8(is_layout, is_digit, digit_lanes)) != UINT32_MAX))
+    return false;
+
+  const __m128i low = _mm256_castsi256_si128(digits);
+  const __m128i high = _mm256_extracti128_si256(digits, 1);
+#elif defined(__SSE2__)
+  const __m128i zeros = _mm_set1_epi8('0');
+  const __m128i nine = _mm_set1_epi8(9);
+  const __m128i layout_low = _mm_setr_epi8('0', '0', '0', '0', '0', '0', '0', '0', '-', '0', '0', ':', '0', '0', ':', '0');
+  const __m128i layout_high = _mm_setr_epi8('0', '.', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0');
+  const __m128i chunk_low = _mm_load_si128((const __m128i *)timestamp);
+  const __m128i chunk_high = _mm_load_si128((const __m128i *)(timestamp + 16));
+  const __m128i low = _mm_sub_epi8(chunk_low, zeros);
+  const __m128i high = _mm_sub_epi8(chunk_high, zeros);
+
+  const __m128i digit_lanes_low = _mm_cmpeq_epi8(layout_low, zeros);
+  const __m128i digit_lanes_high = _mm_cmpeq_epi8(layout_high, zeros);
+  const __m128i valid_low = _mm_or_si128(
+    _mm_and_si128(digit_lanes_low, _mm_cmpeq_epi8(_mm_min_epu8(low, nine), low)),
+    _mm_andnot_si128(digit_lanes_low, _mm_cmpeq_epi8(chunk_low, layout_low)));
+  const __m128i valid_high = _mm_or_si128(
+    _mm_and_si128(digit_lanes_high, _mm_cmpeq_epi8(_mm_min_epu8(high, nine), high)),
+    _mm_andnot_si128(digit_lanes_high, _mm_cmpeq_epi8(chunk_high, layout_high)));
+
+  if (UNLIKELY(_mm_movemask_epi8(_mm_and_si128(valid_low, valid_high)) != 0xFFFF))
+    return false;
+#else
+  constexpr char layout[] = "00000000-00:00:00.00000000000000";
+
+  bool valid = true;
+  for (uint8_t i = 0; i < TIMESTAMP_SIZE; i++)
+  {
+    const bool is_digit = (uint8_t)(timestamp[i] - '0') < 10;
+    valid &= (layout[i] == '0') ? is_digit : (timestamp[i] == layout[i]);
+  }
+
+  if (UNLIKELY(!valid))
+    return false;
+#endif
+
+#if defined(__SSSE3__)
+  //pairs: YY YY MM DD HH MM SS 0s | ss ss ss ss
+  const __m128i from_low = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 9, 10, 12, 13, 15, -1, -1, -1);
+  const __m128i from_high = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, -1, 2);
+  const __m128i date_time = _mm_or_si128(_mm_shuffle_epi8(low, from_low), _mm_shuffle_epi8(high, from_high));
+  const __m128i fraction = _mm_srli_si128(high, 3);
+
+  const __m128i weights = _mm_set1_epi16(0x010A);
+  const __m128i date_time_pairs = _mm_maddubs_epi16(date_time, weights);
+  const __m128i fraction_quads = _mm_madd_epi16(_mm_maddubs_epi16(fraction, weights), _mm_setr_epi16(100, 1, 100, 1, 0, 0, 0, 0));
+
+  uint16_t pairs[8];
+  uint32_t quads[4];
+  _mm_storeu_si128((__m128i *)pairs, date_time_pairs);
+  _mm_storeu_si128((__m128i *)quads, fraction_quads);
+
+  *parts = (timestamp_t){
+    .year = pairs[0] * 100 + pairs[1],
+    .month = pairs[2],
+    .day = pairs[3],
+    .hour = pairs[4],
+    .minute = pairs[5],
+    .second = pairs[6],
+    .nanosecond = pairs[7] * 100000000U + quads[0] * 10000U + quads[1]
+  };
+#else
+  *parts = (timestamp_t){
+    .year = pair(timestamp) * 100 + pair(timestamp + 2),
+    .month = pair(timestamp + 4),
+    .day = pair(timestamp + 6),
+    .hour = pair(timestamp + 9),
+    .minute = pair(timestamp + 12),
+    .second = pair(timestamp + 15),
+    .nanosecond = (timestamp[18] - '0') * 100000000U + (pair(timestamp + 19) * 100U + pair(timestamp + 21)) * 10000U + pair(timestamp + 23) * 100U + pair(timestamp + 25)
+  };
+#endif
+
+  return true;
+}
+
+static inline uint8_t pair(const char *digits)
+{
+  return (digits[0] - '0') * 10 + (digits[1] - '0');
+}
\ No newline at end of file
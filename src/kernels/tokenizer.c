@@ -0,0 +1,374 @@
+/*================================================================================
+
+File: tokenizer.c                                                               
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:26:12                                                 
+last edited: 2026-10-17 08:26:22                                                
+
+================================================================================*/
+
+#include "kernels.h"
+#include <string.h>
+
+typedef struct
+{
+  fix_field_t *fields;
+  uint16_t field_count;
+  uint16_t max_fields;
+  char *tag;
+  char *delim;
+  fix_tag_index_t *index;
+  bool parse_tags;
+  field_visitor_t visitor;
+  void *context;
+  fix_compact_message_t *compact;
+  bool terminate;
+} tokenizer_t;
+
+static ALWAYS_INLINE inline bool scan_blocks(tokenizer_t *restrict tokenizer, char *buffer, char *body_start, const char *checksum_start, uint8_t *restrict checksum);
+static ALWAYS_INLINE inline bool tokenize_block(tokenizer_t *restrict tokenizer, char *block, uint64_t equals, uint64_t soh);
+static inline uint64_t range_mask(const char *block, const char *start, const char *end);
+static inline const char *load_block(const char *block, const char *start, const char *end, char *restrict staging);
+static inline void structural_masks(const char *block, uint64_t *restrict equals, uint64_t *restrict soh);
+
+/*
+  structural index: the '=' and SOH positions of each 64 bytes block are collected in two bitmasks,
+  then the field boundaries are extracted with tzcnt, alternating between the two masks.
+  blocks are aligned, the first and the last one are read through a zeroed copy of their bytes in range.
+*/
+bool KERNEL(tokenize)(char *buffer, const char *const end, fix_message_t *const restrict message)
+{
+  tokenizer_t tokenizer = {
+    .fields = message->fields,
+    .field_count = 0,
+    .max_fields = message->field_count,
+    .tag = buffer,
+    .delim = NULL,
+    .index = message->index,
+    .parse_tags = (message->flags & FF_PARSE_TAGS) || message->index,
+    .visitor = NULL,
+    .context = NULL,
+    .compact = NULL,
+    .terminate = !(message->flags & FF_KEEP_DELIMITERS)
+  };
+
+  char *block = (char *)((uintptr_t)buffer & ~(uintptr_t)(BLOCK_SIZE - 1));
+  char staging[BLOCK_SIZE] ALIGNED(BLOCK_SIZE);
+
+  while (LIKELY(block < end))
+  {
+    uint64_t equals;
+    uint64_t soh;
+    structural_masks(load_block(block, buffer, end, staging), &equals, &soh);
+
+    if (UNLIKELY(!tokenize_block(&tokenizer, block, equals, soh)))
+      return false;
+
+    block += BLOCK_SIZE;
+  }
+
+  if (UNLIKELY(tokenizer.tag != end))
+    return false;
+
+  message->field_count = tokenizer.field_count;
+  return true;
+}
+
+/*
+  single pass over the message: each block is loaded once, and the same load feeds the checksum
+  (header and body bytes) and the structural masks (body bytes only). the bytes out of range are zero, so they add
+  nothing to the checksum.
+*/
+bool KERNEL(scan_message)(char *buffer, char *body_start, const char *checksum_start, fix_message_t *const restrict message, uint8_t *restrict checksum)
+{
+  tokenizer_t tokenizer = {
+    .fields = message->fields,
+    .field_count = 0,
+    .max_fields = message->field_count,
+    .tag = body_start,
+    .delim = NULL,
+    .index = message->index,
+    .parse_tags = (message->flags & FF_PARSE_TAGS) || message->index,
+    .visitor = NULL,
+    .context = NULL,
+    .compact = NULL,
+    .terminate = !(message->flags & FF_KEEP_DELIMITERS)
+  };
+
+  if (UNLIKELY(!scan_blocks(&tokenizer, buffer, body_start, checksum_start, checksum)))
+    return false;
+
+  message->field_count = tokenizer.field_count;
+  return true;
+}
+
+//same scan as scan_message, but every field is handed to visitor instead of being stored
+bool KERNEL(scan_fields)(char *buffer, char *body_start, const char *checksum_start, field_visitor_t visitor, void *context, uint8_t *restrict checksum)
+{
+  tokenizer_t tokenizer = {
+    .fields = NULL,
+    .field_count = 0,
+    .max_fields = UINT16_MAX,
+    .tag = body_start,
+    .delim = NULL,
+    .index = NULL,
+    .parse_tags = true,
+    .visitor = visitor,
+    .context = context,
+    .compact = NULL,
+    .terminate = true
+  };
+
+  return scan_blocks(&tokenizer, buffer, body_start, checksum_start, checksum);
+}
+
+//same scan as scan_message, but only the offsets of the fields are stored and the buffer is left untouched
+bool KERNEL(scan_compact)(char *buffer, char *body_start, const char *checksum_start, fix_compact_message_t *const restrict message, uint8_t *restrict checksum)
+{
+  tokenizer_t tokenizer = {
+    .fields = NULL,
+    .field_count = 0,
+    .max_fields = message->field_count,
+    .tag = body_start,
+    .delim = NULL,
+    .index = NULL,
+    .parse_tags = false,
+    .visitor = NULL,
+    .context = NULL,
+    .compact = message,
+    .terminate = false
+  };
+
+  if (UNLIKELY(!scan_blocks(&tokenizer, buffer, body_start, checksum_start, checksum)))
+    return false;
+
+  message->field_count = tokenizer.field_count;
+  return true;
+}
+
+static ALWAYS_INLINE inline bool scan_blocks(tokenizer_t *restrict tokenizer, char *buffer, char *body_start, const char *checksum_start, uint8_t *restrict checksum)
+{
+  char *block = (char *)((uintptr_t)buffer & ~(uintptr_t)(BLOCK_SIZE - 1));
+  char staging[BLOCK_SIZE] ALIGNED(BLOCK_SIZE);
+
+#if defined(__AVX512BW__)
+  const __m512i vec_nulls_512 = _mm512_setzero_si512();
+  const __m512i vec_equals_512 = _mm512_set1_epi8('=');
+  const __m512i vec_soh_512 = _mm512_set1_epi8('\x01');
+  __m512i sum = _mm512_setzero_si512();
+#elif defined(__AVX2__)
+  const __m256i vec_nulls_256 = _mm256_setzero_si256();
+  const __m256i vec_equals_256 = _mm256_set1_epi8('=');
+  const __m256i vec_soh_256 = _mm256_set1_epi8('\x01');
+  __m256i sum = _mm256_setzero_si256();
+#elif defined(__SSE2__)
+  const __m128i vec_nulls_128 = _mm_setzero_si128();
+  const __m128i vec_equals_128 = _mm_set1_epi8('=');
+  const __m128i vec_soh_128 = _mm_set1_epi8('\x01');
+  __m128i sum = _mm_setzero_si128();
+#else
+  uint64_t sum = 0;
+#endif
+
+  while (LIKELY(block < checksum_start))
+  {
+    const char *const data = load_block(block, buffer, checksum_start, staging);
+    const uint64_t body_range = range_mask(block, body_start, checksum_start);
+    uint64_t equals;
+    uint64_t soh;
+
+#if defined(__AVX512BW__)
+    const __m512i chunk = _mm512_load_si512((const __m512i *)data);
+    sum = _mm512_add_epi64(sum, _mm512_sad_epu8(chunk, vec_nulls_512));
+    equals = _mm512_cmpeq_epi8_mask(chunk, vec_equals_512);
+    soh = _mm512_cmpeq_epi8_mask(chunk, vec_soh_512);
+#elif defined(__AVX2__)
+    equals = 0;
+    soh = 0;
+
+    for (uint8_t i = 0; i < BLOCK_SIZE; i += 32)
+    {
+      const __m256i chunk = _mm256_load_si256((const __m256i *)(data + i));
+      equals |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, vec_equals_256)) << i;
+      soh |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, vec_soh_256)) << i;
+      sum = _mm256_add_epi64(sum, _mm256_sad_epu8(chunk, vec_nulls_256));
+    }
+#elif defined(__SSE2__)
+    equals = 0;
+    soh = 0;
+
+    for (uint8_t i = 0; i < BLOCK_SIZE; i += 16)
+    {
+      const __m128i chunk = _mm_load_si128((const __m128i *)(data + i));
+      equals |= (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vec_equals_128)) << i;
+      soh |= (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vec_soh_128)) << i;
+      sum = _mm_add_epi64(sum, _mm_sad_epu8(chunk, vec_nulls_128));
+    }
+#else
+    structural_masks(data, &equals, &soh);
+    for (uint8_t i = 0; i < BLOCK_SIZE; i++)
+      sum += (uint8_t)data[i];
+#endif
+
+    if (UNLIKELY(!tokenize_block(tokenizer, block, equals & body_range, soh & body_range)))
+      return false;
+
+    block += BLOCK_SIZE;
+  }
+
+#if defined(__AVX512BW__)
+  *checksum = (uint8_t)_mm512_reduce_add_epi64(sum);
+#elif defined(__AVX2__)
+  const __m128i sum_total = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  *checksum = (uint8_t)(_mm_cvtsi128_si64(sum_total) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(sum_total, sum_total)));
+#elif defined(__SSE2__)
+  *checksum = (uint8_t)(_mm_cvtsi128_si64(sum) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(sum, sum)));
+#else
+  *checksum = (uint8_t)sum;
+#endif
+
+  return tokenizer->tag == checksum_start;
+}
+
+//consumes the delimiters of one block, carrying a field split across blocks in the tokenizer state
+static ALWAYS_INLINE inline bool tokenize_block(tokenizer_t *restrict tokenizer, char *block, uint64_t equals, uint64_t soh)
+{
+  while (true)
+  {
+    if (!tokenizer->delim)
+    {
+      const uint64_t first_soh = soh & -soh;
+      const uint64_t first_equals = equals & -equals;
+      if (UNLIKELY(first_soh && (!first_equals || first_soh < first_equals)))
+        return false;
+      if (!equals)
+        return true;
+
+      const uint8_t offset = __builtin_ctzll(equals); //TODO stdc_trailing_zeros(equals);
+      tokenizer->delim = block + offset;
+      if (tokenizer->terminate)
+        *tokenizer->delim = '\0';
+
+      const uint64_t consumed = ~((2ULL << offset) - 1);
+      equals &= consumed;
+      soh &= consumed;
+    }
+
+    if (!soh)
+      return true;
+
+    const uint8_t offset = __builtin_ctzll(soh); //TODO stdc_trailing_zeros(soh);
+    char *const field_end = block + offset;
+    if (tokenizer->terminate)
+      *field_end = '\0';
+
+    if (UNLIKELY(tokenizer->field_count >= tokenizer->max_fields))
+      return false;
+
+    const uint16_t field = tokenizer->field_count++;
+
+    const uint16_t tag_len = tokenizer->delim - tokenizer->tag;
+    const uint32_t tag_num = tokenizer->parse_tags ? parse_tag(tokenizer->tag, tag_len) : 0;
+    const uint16_t value_len = field_end - tokenizer->delim - 1;
+
+    if (tokenizer->compact)
+    {
+      fix_compact_message_t *const compact = tokenizer->compact;
+      compact->tags[field] = tokenizer->tag - compact->buffer;
+      compact->values[field] = tokenizer->delim + 1 - compact->buffer;
+      compact->value_lens[field] = value_len;
+    }
+    else if (tokenizer->visitor)
+    {
+      if (UNLIKELY(!tokenizer->visitor(tokenizer->context, tag_num, tokenizer->delim + 1, value_len)))
+        return false;
+    }
+    else
+    {
+      *tokenizer->fields++ = (fix_field_t){
+        .tag = tokenizer->tag,
+        .value = tokenizer->delim + 1,
+        .tag_len = tag_len,
+        .value_len = value_len,
+        .tag_num = tag_num
+      };
+
+      if (tokenizer->index)
+        index_field(tokenizer->index, tag_num, field);
+    }
+
+    tokenizer->tag = field_end + 1;
+    tokenizer->delim = NULL;
+
+    const uint64_t consumed = ~((2ULL << offset) - 1);
+    equals &= consumed;
+    soh &= consumed;
+  }
+}
+
+//bits of the block that fall in [start, end)
+static inline uint64_t range_mask(const char *block, const char *start, const char *end)
+{
+  const ptrdiff_t low = start - block;
+  const ptrdiff_t high = end - block;
+
+  const uint64_t from_low = (low <= 0) ? ~0ULL : (low >= BLOCK_SIZE) ? 0 : ~0ULL << low;
+  const uint64_t below_high = (high >= BLOCK_SIZE) ? ~0ULL : (high <= 0) ? 0 : (1ULL << high) - 1;
+  return from_low & below_high;
+}
+
+/*
+  the bytes of a block outside [start, end) can belong to another allocation: a block that is not entirely in range is
+  copied to staging with the bytes out of range zeroed, which match neither '=' nor SOH.
+*/
+static inline const char *load_block(const char *block, const char *start, const char *end, char *restrict staging)
+{
+  if (LIKELY(block >= start && block + BLOCK_SIZE <= end))
+    return block;
+
+  const char *const from = (start > block) ? start : block;
+  const char *const to = (end < block + BLOCK_SIZE) ? end : block + BLOCK_SIZE;
+
+  memset(staging, 0, BLOCK_SIZE);
+  memcpy(staging + (from - block), from, to - from);
+  return staging;
+}
+
+static inline void structural_masks(const char *block, uint64_t *restrict equals, uint64_t *restrict soh)
+{
+#if defined(__AVX512BW__)
+  const __m512i vec_equals_512 = _mm512_set1_epi8('=');
+  const __m512i vec_soh_512 = _mm512_set1_epi8('\x01');
+  const __m512i chunk = _mm512_load_si512((const __m512i *)block);
+  *equals = _mm512_cmpeq_epi8_mask(chunk, vec_equals_512);
+  *soh = _mm512_cmpeq_epi8_mask(chunk, vec_soh_512);
+#elif defined(__AVX2__)
+  const __m256i vec_equals_256 = _mm256_set1_epi8('=');
+  const __m256i vec_soh_256 = _mm256_set1_epi8('\x01');
+  const __m256i low = _mm256_load_si256((const __m256i *)block);
+  const __m256i high = _mm256_load_si256((const __m256i *)(block + 32));
+  *equals = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, vec_equals_256)) | ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, vec_equals_256)) << 32);
+  *soh = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, vec_soh_256)) | ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, vec_soh_256)) << 32);
+#elif defined(__SSE2__)
+  const __m128i vec_equals_128 = _mm_set1_epi8('=');
+  const __m128i vec_soh_128 = _mm_set1_epi8('\x01');
+  *equals = 0;
+  *soh = 0;
+  for (uint8_t i = 0; i < BLOCK_SIZE; i += 16)
+  {
+    const __m128i chunk = _mm_load_si128((const __m128i *)(block + i));
+    *equals |= (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vec_equals_128)) << i;
+    *soh |= (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vec_soh_128)) << i;
+  }
+#else
+  *equals = 0;
+  *soh = 0;
+  for (uint8_t i = 0; i < BLOCK_SIZE; i++)
+  {
+    *equals |= (uint64_t)(block[i] == '=') << i;
+    *soh |= (uint64_t)(block[i] == '\x01') << i;
+  }
+#endif
+}
\ No newline at end of file
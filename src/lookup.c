@@ -0,0 +1,73 @@
+/*================================================================================
+
+File: lookup.c                                                                  
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:30:45                                                 
+last edited: 2026-10-17 08:27:28                                                
+
+================================================================================*/
+
+#include "common.h"
+#include "lookup.h"
+#include <string.h>
+
+static const fix_field_t *find_field(const fix_message_t *restrict message, const uint32_t tag);
+
+void index_reset(fix_tag_index_t *index)
+{
+  index->presence = 0;
+  index->overflow = false;
+
+  //stamps are 16 bits wide, on wrap around the stale entries would look current again
+  if (UNLIKELY(++index->generation == 0))
+  {
+    memset(index->direct, 0, sizeof(index->direct));
+    memset(index->hashed, 0, sizeof(index->hashed));
+    index->generation = 1;
+  }
+}
+
+/*
+  returns the first field with the given tag, NULL if the message doesn't contain it.
+  generation 0 is never used by index_reset: the zeroed stamps of an index that was never filled would match it.
+*/
+const fix_field_t *ff_get_field(const fix_message_t *restrict message, const uint32_t tag)
+{
+  const fix_tag_index_t *const index = message->index;
+  if (UNLIKELY(!index || !index->generation))
+    return find_field(message, tag);
+
+  if (LIKELY(tag < FF_INDEX_DIRECT_TAGS))
+  {
+    const uint32_t stamp = index->direct[tag];
+    return ((stamp >> 16) == index->generation) ? &message->fields[stamp & 0xFFFF] : NULL;
+  }
+
+  uint8_t slot = index_slot(tag);
+  for (uint8_t probes = 0; probes < FF_INDEX_HASHED_SLOTS; probes++)
+  {
+    const uint32_t stamp = index->hashed[slot].stamp;
+    if ((stamp >> 16) != index->generation)
+      break;
+
+    if (index->hashed[slot].tag == tag)
+      return &message->fields[stamp & 0xFFFF];
+
+    slot = (slot + 1) & (FF_INDEX_HASHED_SLOTS - 1);
+  }
+
+  return UNLIKELY(index->overflow) ? find_field(message, tag) : NULL;
+}
+
+static const fix_field_t *find_field(const fix_message_t *restrict message, const uint32_t tag)
+{
+  for (uint16_t i = 0; i < message->field_count; i++)
+  {
+    if (tag_to_uint(message->fields[i].tag, message->fields[i].tag_len) == tag)
+      return &message->fields[i];
+  }
+
+  return NULL;
+}
\ No newline at end of file
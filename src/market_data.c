@@ -0,0 +1,116 @@
+/*================================================================================
+
+File: market_data.c                                                             
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:57:48                                                 
+last edited: 2026-10-17 06:57:48                                                
+
+================================================================================*/
+
+#include "common.h"
+#include "market_data.h"
+#include "values.h"
+#include <string.h>
+
+typedef struct
+{
+  ff_md_columns_t *columns;
+  uint32_t expected;
+  int32_t row;
+  bool refresh;
+} md_decoder_t;
+
+static bool decode_field(void *context, const uint32_t tag, const char *value, const uint16_t value_len);
+static inline bool start_entry(md_decoder_t *restrict decoder);
+
+/*
+  decodes a MarketDataIncrementalRefresh (35=X) straight into columns, without a fix_field_t array:
+  the fields are handed to decode_field by the same single pass scan that checksums the message.
+  a row starts at each MDUpdateAction(279), missing prices, sizes and times are 0 and a missing symbol repeats the previous one.
+  without resolve_symbol, symbols are expected to be numeric ids.
+*/
+uint16_t ff_decode_md_incremental(char *restrict buffer, const uint16_t buffer_size, ff_md_columns_t *restrict columns)
+{
+  const char *const checksum_start = frame(buffer, buffer_size);
+  if (UNLIKELY(!checksum_start))
+    return 0;
+
+  char *const body_start = (char *)rawmemchr(buffer + STR_LEN("8=FIX.4.4\x01""9="), '\x01') + 1;
+  const char *checksum_end;
+  const uint8_t provided_checksum = (uint8_t)atoui(checksum_start + STR_LEN("10="), &checksum_end);
+
+  md_decoder_t decoder = {
+    .columns = columns,
+    .expected = UINT32_MAX,
+    .row = -1,
+    .refresh = false
+  };
+  columns->count = 0;
+
+  uint8_t checksum;
+  bool valid = scan_fields(buffer, body_start, checksum_start, decode_field, &decoder, &checksum);
+  valid &= (checksum == provided_checksum);
+  valid &= decoder.refresh;
+  valid &= (decoder.expected == (uint32_t)(decoder.row + 1));
+  return (checksum_end + STR_LEN("\x01") - buffer) * valid;
+}
+
+static bool decode_field(void *context, const uint32_t tag, const char *value, const uint16_t value_len)
+{
+  md_decoder_t *const decoder = context;
+  ff_md_columns_t *const columns = decoder->columns;
+  const int32_t row = decoder->row;
+
+  switch (tag)
+  {
+    case 35:
+      decoder->refresh = (value_len == 1) & (*value == 'X');
+      return decoder->refresh;
+    case 268:
+      decoder->expected = tag_to_uint(value, value_len);
+      return (decoder->expected <= columns->capacity) & (row < 0);
+    case 279:
+      if (UNLIKELY(!start_entry(decoder)))
+        return false;
+      columns->actions[decoder->row] = *value;
+      return value_len == 1;
+    case 269:
+      if (UNLIKELY(row < 0))
+        return false;
+      columns->types[row] = *value;
+      return value_len == 1;
+    case 55:
+      if (UNLIKELY(row < 0))
+        return true;
+      columns->symbols[row] = columns->resolve_symbol ? columns->resolve_symbol(columns->resolver_context, value, value_len) : tag_to_uint(value, value_len);
+      return true;
+    case 270:
+      return (row >= 0) && ff_decode_decimal(value, value_len, columns->price_scale, &columns->prices[row]);
+    case 271:
+      return (row >= 0) && ff_decode_decimal(value, value_len, 0, &columns->sizes[row]);
+    case 273:
+      return (row >= 0) && ff_decode_time(value, value_len, &columns->times[row]);
+    default:
+      return true;
+  }
+}
+
+static inline bool start_entry(md_decoder_t *restrict decoder)
+{
+  ff_md_columns_t *const columns = decoder->columns;
+  const int32_t row = ++decoder->row;
+
+  //NoMDEntries(268) comes before the entries and bounds them
+  if (UNLIKELY(decoder->expected == UINT32_MAX || (uint32_t)row >= decoder->expected))
+    return false;
+
+  columns->types[row] = '\0';
+  columns->symbols[row] = row ? columns->symbols[row - 1] : 0;
+  columns->prices[row] = 0;
+  columns->sizes[row] = 0;
+  columns->times[row] = 0;
+  columns->count = row + 1;
+  return true;
+}
\ No newline at end of file
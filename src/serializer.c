@@ -5,7 +5,7 @@ Creator: Claudio Raimondi
 Email: claudio.raimondi@pm.me                                                   
 
 created at: 2025-02-11 12:37:26                                                 
-last edited: 2025-03-05 20:59:03                                                
+last edited: 2026-10-17 07:52:29                                                
 
 ================================================================================*/
 
@@ -13,50 +13,66 @@ last edited: 2025-03-05 20:59:03
 #include "serializer.h"
 #include <string.h>
 
-static inline uint16_t compute_body_length(const fix_field_t *fields, uint16_t field_count);
-static uint8_t utoa(uint16_t num, char *buffer);
-ALWAYS_INLINE static inline uint16_t div100(uint16_t n);
-ALWAYS_INLINE static inline uint16_t mul100(uint16_t n);
+static inline void write_digits(char *restrict buffer, uint64_t value, const uint8_t len);
+static uint8_t encode_fixed(char *restrict buffer, const bool negative, const uint64_t magnitude, const uint8_t scale);
+static uint8_t encode_fallback(char *restrict buffer, const double value);
 
-#ifdef __AVX512F__
-  static __m512i _512_len_offsets;
-  static __m512i _512_mask_lower_16;
-#endif
+uint16_t ff_serialize(char *restrict buffer, const fix_message_t *restrict message)
+{
+  return serialize_message(buffer, message, compute_body_length(message->fields, message->field_count));
+}
 
-#ifdef __AVX2__
-  //TODO define constants
-#endif
+//for callers that already computed the body length, e.g. to check that the message fits
+uint16_t serialize_message(char *restrict buffer, const fix_message_t *restrict message, const uint16_t body_length)
+{
+  char *body = buffer + STR_LEN("8=FIX.4.4\x01""9=\x01") + count_digits(body_length);
 
-#ifdef __SSE2__
-  //TODO define constants
-#endif
+  uint8_t checksum;
+  prepend_header(body, body_length, &checksum);
+
+  uint8_t body_sum;
+  char *const end = write_fields(body, message->fields, message->field_count, &body_sum);
+
+  return write_checksum(end, checksum + body_sum) - buffer;
+}
 
-CONSTRUCTOR void ff_serializer_init(void)
+//the body length is summed from the offset arrays, no pointer chasing
+uint16_t ff_serialize_compact(char *restrict buffer, const fix_compact_message_t *restrict message)
 {
-#ifdef __AVX512F__
-  _512_len_offsets = _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0); 
-  _512_mask_lower_16 = _mm512_set1_epi32(0x0000FFFF);
-#endif
+  const uint16_t body_length = compact_body_length(message);
+  char *body = buffer + STR_LEN("8=FIX.4.4\x01""9=\x01") + count_digits(body_length);
+
+  uint8_t checksum;
+  prepend_header(body, body_length, &checksum);
+
+  uint8_t body_sum;
+  char *const end = write_compact_fields(body, message, &body_sum);
+
+  return write_checksum(end, checksum + body_sum) - buffer;
 }
 
-uint16_t ff_serialize(char *restrict buffer, const fix_message_t *restrict message)
+//the body is written first at a fixed offset, so its length is known without a pass over the fields
+char *ff_serialize_reserved(char *restrict buffer, const fix_message_t *restrict message, uint16_t *restrict len)
+{
+  char *const body = buffer + FF_HEADER_RESERVED_LEN;
+
+  uint8_t body_sum;
+  char *const end = write_fields(body, message->fields, message->field_count, &body_sum);
+
+  uint8_t checksum;
+  char *const start = prepend_header(body, end - body, &checksum);
+
+  *len = write_checksum(end, checksum + body_sum) - start;
+  return start;
+}
+
+uint16_t ff_serialize_raw(char *restrict buffer, const fix_message_t *restrict message)
 {
   const char *const buffer_start = buffer;
 
   const uint16_t field_count = message->field_count;
   const fix_field_t *fields = message->fields;
 
-  memcpy8(buffer, "8=FIX.4.");
-  buffer += 8;
-  memcpy4(buffer, "4\x01""9=");
-  buffer += 4;
-
-  const uint16_t body_length = compute_body_length(fields, field_count);
-  const uint8_t body_length_len = utoa(body_length, buffer);
-  buffer += body_length_len;
-  *buffer++ = '\x01';
-
-  //TODO code duplication (see ff_serialize_raw)
   for (uint16_t i = 0; LIKELY(i < field_count); i++)
   {
     const char *tag = fields[0].tag;
@@ -74,6 +90,87 @@ uint16_t ff_serialize(char *restrict buffer, const fix_message_t *restrict messa
     fields++;
   }
 
+  return buffer - buffer_start;
+}
+
+uint8_t ff_encode_uint(char *restrict buffer, const uint64_t value)
+{
+  const uint8_t len = count_digits(value);
+  write_digits(buffer, value, len);
+  return len;
+}
+
+uint8_t ff_encode_int(char *restrict buffer, const int64_t value)
+{
+  const bool negative = (value < 0);
+  *buffer = '-';
+
+  const uint64_t magnitude = negative ? -(uint64_t)value : (uint64_t)value;
+  return negative + ff_encode_uint(buffer + negative, magnitude);
+}
+
+//value has scale implied decimals, trailing zeros of the fraction are not written. 0 if scale is above FF_ENCODE_MAX_SCALE
+uint8_t ff_encode_decimal(char *restrict buffer, const int64_t value, const uint8_t scale)
+{
+  if (UNLIKELY(scale > FF_ENCODE_MAX_SCALE))
+    return 0;
+
+  const bool negative = (value < 0);
+  const uint64_t magnitude = negative ? -(uint64_t)value : (uint64_t)value;
+  return encode_fixed(buffer, negative, magnitude, scale);
+}
+
+/*
+  shortest round trip: the first k for which m / 10^k gives back exactly the same double is written as the decimal m with scale k.
+  while m and 10^k are exact doubles the division is correctly rounded, so parsing the decimal yields the same double.
+*/
+uint8_t ff_encode_double(char *restrict buffer, const double value)
+{
+  static const double exact_powers_of_10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17
+  };
+  constexpr double max_exact = 9007199254740992.0;
+
+  for (uint8_t k = 0; k < sizeof(exact_powers_of_10) / sizeof(exact_powers_of_10[0]); k++)
+  {
+    const double scaled = value * exact_powers_of_10[k];
+    if (UNLIKELY(!(scaled > -max_exact && scaled < max_exact)))
+      break;
+
+    const int64_t m = (int64_t)(scaled + ((scaled < 0) ? -0.5 : 0.5));
+    if ((double)m / exact_powers_of_10[k] == value)
+      return ff_encode_decimal(buffer, m, k);
+  }
+
+  return encode_fallback(buffer, value);
+}
+
+//writes "8=FIX.4.4\x01""9=<body_len>\x01" right before body
+char *prepend_header(char *body, const uint16_t body_len, uint8_t *restrict checksum)
+{
+  //sum of "8=FIX.4.4\x01" "9=" and of the SOH after BodyLength
+  constexpr uint16_t header_sum = 664;
+
+  const uint8_t digits = count_digits(body_len);
+  char *const start = body - STR_LEN("8=FIX.4.4\x01""9=\x01") - digits;
+  char *const length = start + STR_LEN("8=FIX.4.4\x01""9=");
+
+  memcpy8(start, "8=FIX.4.");
+  memcpy4(start + 8, "4\x01""9=");
+  write_digits(length, body_len, digits);
+  body[-1] = '\x01';
+
+  uint8_t sum = (uint8_t)header_sum;
+  for (uint8_t i = 0; i < digits; i++)
+    sum += length[i];
+
+  *checksum = sum;
+  return start;
+}
+
+//writes "10=<checksum>\x01"
+char *write_checksum(char *restrict buffer, const uint8_t checksum)
+{
   constexpr char checksum_table[256][4] = {
     {"000\x01"}, {"001\x01"}, {"002\x01"}, {"003\x01"}, {"004\x01"}, {"005\x01"}, {"006\x01"}, {"007\x01"}, {"008\x01"}, {"009\x01"},
     {"010\x01"}, {"011\x01"}, {"012\x01"}, {"013\x01"}, {"014\x01"}, {"015\x01"}, {"016\x01"}, {"017\x01"}, {"018\x01"}, {"019\x01"},
@@ -103,125 +200,89 @@ uint16_t ff_serialize(char *restrict buffer, const fix_message_t *restrict messa
     {"250\x01"}, {"251\x01"}, {"252\x01"}, {"253\x01"}, {"254\x01"}, {"255\x01"}
   };
 
-  const uint8_t checksum = compute_checksum(buffer_start, buffer);
-
   memcpy4(buffer, "10=");
   buffer += 3;
   memcpy4(buffer, checksum_table[checksum]);
   buffer += 4;
 
-  return buffer - buffer_start;
+  return buffer;
 }
 
-uint16_t ff_serialize_raw(char *restrict buffer, const fix_message_t *restrict message)
+//writes exactly len digits, two at a time starting from the least significant ones
+static inline void write_digits(char *restrict buffer, uint64_t value, const uint8_t len)
 {
-  const char *const buffer_start = buffer;
-
-  const uint16_t field_count = message->field_count;
-  const fix_field_t *fields = message->fields;
+  char *cursor = buffer + len;
 
-  for (uint16_t i = 0; LIKELY(i < field_count); i++)
+  while (value >= 100)
   {
-    const char *tag = fields[0].tag;
-    const char *value = fields[0].value;
-    const uint16_t tag_len = fields[0].tag_len;
-    const uint16_t value_len = fields[0].value_len;
-
-    memcpy(buffer, tag, tag_len);
-    buffer += tag_len;
-    *buffer++ = '=';
-    memcpy(buffer, value, value_len);
-    buffer += value_len;
-    *buffer++ = '\x01';
+    const uint64_t q = value / 100;
+    cursor -= 2;
+    memcpy2(cursor, digit_pairs + ((value - q * 100) << 1));
+    value = q;
+  }
 
-    fields++;
+  if (value >= 10)
+  {
+    cursor -= 2;
+    memcpy2(cursor, digit_pairs + (value << 1));
   }
+  else if (cursor > buffer)
+    *--cursor = '0' + value;
 
-  return buffer - buffer_start;
+  while (cursor > buffer)
+    *--cursor = '0';
 }
 
-static inline uint16_t compute_body_length(const fix_field_t *fields, uint16_t field_count)
+//scales past the end of powers_of_10 only come from encode_fallback, for magnitudes below 1 that have no integer part
+static uint8_t encode_fixed(char *restrict buffer, const bool negative, const uint64_t magnitude, const uint8_t scale)
 {
-  uint16_t total_len = (field_count << 1);
-
-#ifdef __AVX512F__
-  while (LIKELY(field_count >= 16))
-  {
-    const __m512i lengths = _mm512_i32gather_epi32(_512_len_offsets, fields, sizeof(fix_field_t));
-
-    const __m512i tag_len = _mm512_and_si512(lengths, _512_mask_lower_16);
-    const __m512i value_len = _mm512_srli_epi32(lengths, 16);
+  const char *const buffer_start = buffer;
 
-    const __m512i sum = _mm512_add_epi32(tag_len, value_len);
-    total_len += _mm512_reduce_add_epi32(sum);
+  *buffer = '-';
+  buffer += negative;
 
-    field_count -= 16;
-    fields += 16;
-  }
-#endif
+  const bool has_int_part = (scale < sizeof(powers_of_10) / sizeof(powers_of_10[0]));
+  const uint64_t int_part = has_int_part ? magnitude / powers_of_10[scale] : 0;
+  uint64_t frac_part = has_int_part ? magnitude - int_part * powers_of_10[scale] : magnitude;
 
-//TODO: Implement AVX2 and SSE2 versions (they dont have reduce, so we need to use _mm256_extract_epi32 and _mm_extract_epi32)
+  buffer += ff_encode_uint(buffer, int_part);
+  if (!frac_part)
+    return buffer - buffer_start;
 
-  while (LIKELY(field_count--))
+  uint8_t frac_len = scale;
+  while (frac_part % 10 == 0)
   {
-    total_len += fields->tag_len + fields->value_len;
-    fields++;
+    frac_part /= 10;
+    frac_len--;
   }
 
-  return total_len;
+  *buffer++ = '.';
+  write_digits(buffer, frac_part, frac_len);
+  buffer += frac_len;
+
+  return buffer - buffer_start;
 }
 
-//TODO make more readable
-static uint8_t utoa(uint16_t num, char *buffer)
+/*
+  values that need more than 17 decimals or 2^53 units are written with 17 significant digits, which always parse back
+  to the same double. the product is computed in long double: these powers of 10 are exact in its 64 bits of mantissa, so
+  the only rounding is far below the last digit. 0 if they can't be written without an exponent.
+*/
+COLD static uint8_t encode_fallback(char *restrict buffer, const double value)
 {
-  constexpr char digit_pairs_reverse[] =
-    "00" "10" "20" "30" "40" "50" "60" "70" "80" "90"
-    "01" "11" "21" "31" "41" "51" "61" "71" "81" "91"
-    "02" "12" "22" "32" "42" "52" "62" "72" "82" "92"
-    "03" "13" "23" "33" "43" "53" "63" "73" "83" "93"
-    "04" "14" "24" "34" "44" "54" "64" "74" "84" "94"
-    "05" "15" "25" "35" "45" "55" "65" "75" "85" "95"
-    "06" "16" "26" "36" "46" "56" "66" "76" "86" "96"
-    "07" "17" "27" "37" "47" "57" "67" "77" "87" "97"
-    "08" "18" "28" "38" "48" "58" "68" "78" "88" "98"
-    "09" "19" "29" "39" "49" "59" "69" "79" "89" "99";
-
-  char tmp[sizeof(__m128i)] ALIGNED(16) = {0};
-  uint8_t len = 0;
-
-  if (UNLIKELY(num < 10))
-  {
-    *buffer = '0' + num;
-    return 1;
-  }
-
-  while (LIKELY(num >= 100))
-  {
-    const uint16_t q = div100(num);
-    const uint8_t r = num - mul100(q);
-
-    memcpy2(tmp + len, digit_pairs_reverse + (r << 1));
-    num = q;
-  }
-
-  const bool is_single_digit = num < 10;
-  len += is_single_digit;
-  memcpy2(tmp + len - is_single_digit, digit_pairs_reverse + (num << 1));
-  len += 2 - is_single_digit;
-
-  uint8_t i = len;
-  while (LIKELY(i--))
-    *buffer++ = tmp[i];
+  static const long double exact_powers_of_10[] = {
+    1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L, 1e10L,
+    1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L
+  };
 
-  return len;
-}
+  const long double magnitude = (value < 0) ? -(long double)value : (long double)value;
+  if (UNLIKELY(!(magnitude >= 1e-4L && magnitude < 1e17L)))
+    return 0;
 
-static inline uint16_t div100(uint16_t n)
-{ 
-  return ((uint32_t)n * 5243U) >> 19;
-}
+  uint8_t scale = 0;
+  while (magnitude * exact_powers_of_10[scale] < 1e16L)
+    scale++;
 
-static inline uint16_t mul100(uint16_t n)
-{
-  return (n << 6) + (n << 5) + (n << 2);
+  const uint64_t digits = (uint64_t)(magnitude * exact_powers_of_10[scale] + 0.5L);
+  return encode_fixed(buffer, value < 0, digits, scale);
 }
@@ -0,0 +1,469 @@
+/*================================================================================
+
+File: session.c                                                                 
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 07:10:20                                                 
+last edited: 2026-10-17 08:35:23                                                
+
+================================================================================*/
+
+#include "common.h"
+#include "session.h"
+#include "serializer.h"
+#include "lookup.h"
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+#define SLOT_EXTRA 2
+#define SLOT_ORIG_SENDING_TIME 3
+#define SEQ_NUM_WIDTH 10
+#define NS_PER_SECOND 1000000000LL
+
+//one template each, FF_SESSION_ADMIN_MESSAGES in total
+typedef enum
+{
+  ADMIN_LOGON,
+  ADMIN_HEARTBEAT,
+  ADMIN_TEST_REPLY,
+  ADMIN_TEST_REQUEST,
+  ADMIN_RESEND_REQUEST,
+  ADMIN_GAP_FILL,
+  ADMIN_LOGOUT
+} admin_message_t;
+
+static bool create_admin(ff_session_t *restrict session, const admin_message_t type, const ff_session_config_t *restrict config);
+static inline fix_field_t make_field(const char *tag, const char *value);
+static bool read_header(const fix_message_t *restrict message, char *restrict msg_type, uint32_t *restrict seq_num);
+static bool read_uint(const fix_field_t *restrict field, uint32_t *restrict value);
+static inline bool has_flag(const fix_message_t *restrict message, const uint32_t tag);
+static ff_session_event_t on_logon(ff_session_t *session);
+static ff_session_event_t on_logout(ff_session_t *session);
+static ff_session_event_t on_out_of_sequence(ff_session_t *restrict session, const fix_message_t *restrict message, const char msg_type, const uint32_t seq_num);
+static bool on_test_request(ff_session_t *restrict session, const fix_message_t *restrict message);
+static bool on_resend_request(ff_session_t *restrict session, const fix_message_t *restrict message);
+static bool on_sequence_reset(ff_session_t *restrict session, const fix_message_t *restrict message);
+static bool send_admin(ff_session_t *session, const admin_message_t type);
+static bool send_template(ff_session_t *restrict session, ff_template_t *restrict tpl, const uint32_t seq_num);
+static bool send_all(const int32_t fd, const char *restrict buffer, uint16_t len);
+
+/*
+  every admin message is rendered once as a template, sending one only patches MsgSeqNum(34), SendingTime(52),
+  the field that depends on the request, and the checksum.
+*/
+bool ff_session_create(ff_session_t *restrict session, const int32_t fd, const ff_session_config_t *restrict config)
+{
+  *session = (ff_session_t){
+    .fd = fd,
+    .state = FF_SESSION_DISCONNECTED,
+    .next_outbound = 1,
+    .next_inbound = 1,
+    .heartbeat_interval = config->heartbeat_interval * NS_PER_SECOND
+  };
+
+  ff_clock_init(&session->clock, 3);
+
+  for (uint8_t i = 0; i < FF_SESSION_ADMIN_MESSAGES; i++)
+  {
+    if (UNLIKELY(!create_admin(session, i, config)))
+      return false;
+  }
+
+  return true;
+}
+
+bool ff_session_logon(ff_session_t *session)
+{
+  if (UNLIKELY(session->state != FF_SESSION_DISCONNECTED))
+    return false;
+
+  session->state = FF_SESSION_LOGON_SENT;
+  return send_admin(session, ADMIN_LOGON);
+}
+
+bool ff_session_logout(ff_session_t *session)
+{
+  if (UNLIKELY(session->state != FF_SESSION_ACTIVE))
+    return false;
+
+  session->state = FF_SESSION_LOGOUT_SENT;
+  return send_admin(session, ADMIN_LOGOUT);
+}
+
+//tpl must reserve MsgSeqNum(34) and SendingTime(52) as its first two slots
+bool ff_session_send(ff_session_t *restrict session, ff_template_t *restrict tpl)
+{
+  if (UNLIKELY(session->state != FF_SESSION_ACTIVE))
+    return false;
+
+  return send_template(session, tpl, session->next_outbound++);
+}
+
+/*
+  fast path: only MsgType(35) and MsgSeqNum(34) are read, application messages in sequence are returned as they are.
+  the other tags are looked up only for the admin messages that need them.
+*/
+ff_session_event_t ff_session_on_message(ff_session_t *restrict session, const fix_message_t *restrict message)
+{
+  char msg_type = '\0';
+  uint32_t seq_num = 0;
+  if (UNLIKELY(!read_header(message, &msg_type, &seq_num)))
+    return FF_SESSION_EVENT_ERROR;
+
+  //any inbound message answers a pending TestRequest
+  session->last_received = ff_clock_now(&session->clock);
+  session->test_request_pending = false;
+
+  const bool logged_on = (session->state == FF_SESSION_ACTIVE) || (session->state == FF_SESSION_LOGOUT_SENT);
+  if (UNLIKELY(!logged_on && msg_type != 'A'))
+    return FF_SESSION_EVENT_ERROR;
+
+  //in reset mode the sequence number of the message is ignored
+  if (UNLIKELY(msg_type == '4' && !has_flag(message, 123)))
+    return on_sequence_reset(session, message) ? FF_SESSION_EVENT_NONE : FF_SESSION_EVENT_ERROR;
+
+  if (UNLIKELY(seq_num != session->next_inbound))
+    return on_out_of_sequence(session, message, msg_type, seq_num);
+
+  session->next_inbound++;
+  session->resend_pending = false;
+
+  bool handled;
+  switch (msg_type)
+  {
+    case 'A':
+      return on_logon(session);
+    case '5':
+      return on_logout(session);
+    case '0':
+      return FF_SESSION_EVENT_NONE;
+    case '1':
+      handled = on_test_request(session, message);
+      break;
+    case '2':
+      handled = on_resend_request(session, message);
+      break;
+    case '4':
+      handled = on_sequence_reset(session, message);
+      break;
+    default:
+      return FF_SESSION_EVENT_APP;
+  }
+
+  return handled ? FF_SESSION_EVENT_NONE : FF_SESSION_EVENT_ERROR;
+}
+
+/*
+  sends a Heartbeat after heartbeat_interval without outbound traffic, and a TestRequest after 1.2 intervals without
+  inbound traffic. the counterparty has one more interval to answer it. an interval of 0 disables both timers.
+*/
+ff_session_event_t ff_session_poll(ff_session_t *session)
+{
+  if (session->state != FF_SESSION_ACTIVE || session->heartbeat_interval == 0)
+    return FF_SESSION_EVENT_NONE;
+
+  const int64_t now = ff_clock_now(&session->clock);
+  const int64_t interval = session->heartbeat_interval;
+
+  if (UNLIKELY(now - session->last_received > interval + interval / 5))
+  {
+    if (session->test_request_pending)
+    {
+      if (now - session->test_request_sent > interval)
+      {
+        session->state = FF_SESSION_CLOSED;
+        return FF_SESSION_EVENT_TIMEOUT;
+      }
+    }
+    else
+    {
+      session->test_request_pending = true;
+      session->test_request_sent = now;
+
+      //the sequence number of the request doubles as its id
+      ff_template_set_uint(&session->admin[ADMIN_TEST_REQUEST], SLOT_EXTRA, session->next_outbound);
+      if (UNLIKELY(!send_admin(session, ADMIN_TEST_REQUEST)))
+        return FF_SESSION_EVENT_ERROR;
+    }
+  }
+
+  if (UNLIKELY(now - session->last_sent >= interval) && !send_admin(session, ADMIN_HEARTBEAT))
+    return FF_SESSION_EVENT_ERROR;
+
+  return FF_SESSION_EVENT_NONE;
+}
+
+static bool create_admin(ff_session_t *restrict session, const admin_message_t type, const ff_session_config_t *restrict config)
+{
+  static const char msg_types[FF_SESSION_ADMIN_MESSAGES][2] = { "A", "0", "0", "1", "2", "4", "5" };
+
+  char heartbeat_interval[8];
+  heartbeat_interval[ff_encode_uint(heartbeat_interval, config->heartbeat_interval)] = '\0';
+
+  fix_field_t fields[9] = {
+    make_field("35", msg_types[type]),
+    make_field("49", config->sender_comp_id),
+    make_field("56", config->target_comp_id),
+    make_field("34", "1"),
+    make_field("52", "")
+  };
+  uint16_t field_count = 5;
+
+  ff_slot_def_t defs[4] = {
+    { .tag = 34, .width = SEQ_NUM_WIDTH, .variable = true },
+    { .tag = 52, .width = session->clock.len, .variable = false }
+  };
+  uint8_t def_count = 2;
+
+  switch (type)
+  {
+    case ADMIN_LOGON:
+      fields[field_count++] = make_field("98", "0");
+      fields[field_count++] = make_field("108", heartbeat_interval);
+      break;
+    case ADMIN_TEST_REPLY:
+      fields[field_count++] = make_field("112", "0");
+      defs[def_count++] = (ff_slot_def_t){ .tag = 112, .width = FF_SESSION_TEST_REQ_ID_MAX_LEN, .variable = true };
+      break;
+    case ADMIN_TEST_REQUEST:
+      fields[field_count++] = make_field("112", "0");
+      defs[def_count++] = (ff_slot_def_t){ .tag = 112, .width = SEQ_NUM_WIDTH, .variable = true };
+      break;
+    case ADMIN_RESEND_REQUEST:
+      fields[field_count++] = make_field("7", "0");
+      fields[field_count++] = make_field("16", "0");
+      defs[def_count++] = (ff_slot_def_t){ .tag = 7, .width = SEQ_NUM_WIDTH, .variable = true };
+      break;
+    case ADMIN_GAP_FILL:
+      fields[field_count++] = make_field("43", "Y");
+      fields[field_count++] = make_field("122", "");
+      fields[field_count++] = make_field("123", "Y");
+      fields[field_count++] = make_field("36", "0");
+      defs[def_count++] = (ff_slot_def_t){ .tag = 36, .width = SEQ_NUM_WIDTH, .variable = true };
+      defs[def_count++] = (ff_slot_def_t){ .tag = 122, .width = session->clock.len, .variable = false };
+      break;
+    default:
+      break;
+  }
+
+  const fix_message_t message = { .fields = fields, .field_count = field_count };
+  return ff_template_create(&session->admin[type], session->buffers[type], FF_SESSION_ADMIN_BUFFER_SIZE, &message, defs, def_count);
+}
+
+static inline fix_field_t make_field(const char *tag, const char *value)
+{
+  return (fix_field_t){
+    .tag = (char *)tag,
+    .value = (char *)value,
+    .tag_len = strlen(tag),
+    .value_len = strlen(value)
+  };
+}
+
+//the standard header comes first, the scan stops as soon as both tags are found
+static bool read_header(const fix_message_t *restrict message, char *restrict msg_type, uint32_t *restrict seq_num)
+{
+  bool has_type = false;
+  bool has_seq_num = false;
+
+  for (uint16_t i = 0; i < message->field_count && !(has_type && has_seq_num); i++)
+  {
+    const fix_field_t *const field = &message->fields[i];
+    const uint32_t tag = field->tag_num ? field->tag_num : tag_to_uint(field->tag, field->tag_len);
+
+    if (tag == 35)
+    {
+      //multi character types are all application messages
+      *msg_type = (field->value_len == 1) ? field->value[0] : '\0';
+      has_type = true;
+    }
+    else if (tag == 34)
+      has_seq_num = read_uint(field, seq_num);
+  }
+
+  return has_type && has_seq_num;
+}
+
+static bool read_uint(const fix_field_t *restrict field, uint32_t *restrict value)
+{
+  if (UNLIKELY(field->value_len == 0 || field->value_len > SEQ_NUM_WIDTH - 1))
+    return false;
+
+  uint32_t result = 0;
+  for (uint16_t i = 0; i < field->value_len; i++)
+  {
+    const uint8_t digit = field->value[i] - '0';
+    if (UNLIKELY(digit > 9))
+      return false;
+    result = result * 10 + digit;
+  }
+
+  *value = result;
+  return true;
+}
+
+static inline bool has_flag(const fix_message_t *restrict message, const uint32_t tag)
+{
+  const fix_field_t *const field = ff_get_field(message, tag);
+  return field && field->value_len == 1 && field->value[0] == 'Y';
+}
+
+//the initiator is waiting for the answer to its Logon, the acceptor answers
+static ff_session_event_t on_logon(ff_session_t *session)
+{
+  switch (session->state)
+  {
+    case FF_SESSION_LOGON_SENT:
+      session->state = FF_SESSION_ACTIVE;
+      return FF_SESSION_EVENT_LOGON;
+    case FF_SESSION_DISCONNECTED:
+      session->state = FF_SESSION_ACTIVE;
+      return send_admin(session, ADMIN_LOGON) ? FF_SESSION_EVENT_LOGON : FF_SESSION_EVENT_ERROR;
+    default:
+      return FF_SESSION_EVENT_ERROR;
+  }
+}
+
+static ff_session_event_t on_logout(ff_session_t *session)
+{
+  const bool confirmed = (session->state == FF_SESSION_LOGOUT_SENT);
+  session->state = FF_SESSION_CLOSED;
+
+  if (!confirmed && UNLIKELY(!send_admin(session, ADMIN_LOGOUT)))
+    return FF_SESSION_EVENT_ERROR;
+
+  return FF_SESSION_EVENT_LOGOUT;
+}
+
+/*
+  a sequence number too high means messages were lost: they are requested once, the message is not delivered.
+  Logon and ResendRequest are still served first, the counterparty may be waiting for them to fill its own gap.
+  a sequence number too low is only allowed for possible duplicates (43=Y), which are dropped.
+*/
+static ff_session_event_t on_out_of_sequence(ff_session_t *restrict session, const fix_message_t *restrict message, const char msg_type, const uint32_t seq_num)
+{
+  if (seq_num > session->next_inbound)
+  {
+    if (msg_type == 'A' && UNLIKELY(on_logon(session) == FF_SESSION_EVENT_ERROR))
+      return FF_SESSION_EVENT_ERROR;
+
+    if (msg_type == '2' && UNLIKELY(!on_resend_request(session, message)))
+      return FF_SESSION_EVENT_ERROR;
+
+    if (!session->resend_pending)
+    {
+      session->resend_pending = true;
+      ff_template_set_uint(&session->admin[ADMIN_RESEND_REQUEST], SLOT_EXTRA, session->next_inbound);
+      if (UNLIKELY(!send_admin(session, ADMIN_RESEND_REQUEST)))
+        return FF_SESSION_EVENT_ERROR;
+    }
+
+    return (msg_type == 'A') ? FF_SESSION_EVENT_LOGON : FF_SESSION_EVENT_GAP;
+  }
+
+  if (LIKELY(has_flag(message, 43)))
+    return FF_SESSION_EVENT_NONE;
+
+  if (session->state == FF_SESSION_ACTIVE)
+    send_admin(session, ADMIN_LOGOUT);
+  session->state = FF_SESSION_CLOSED;
+  return FF_SESSION_EVENT_ERROR;
+}
+
+//the id is echoed in the Heartbeat, longer ones are rejected rather than truncated
+static bool on_test_request(ff_session_t *restrict session, const fix_message_t *restrict message)
+{
+  const fix_field_t *const test_req_id = ff_get_field(message, 112);
+  if (UNLIKELY(!test_req_id || test_req_id->value_len > FF_SESSION_TEST_REQ_ID_MAX_LEN))
+    return false;
+
+  ff_template_t *const reply = &session->admin[ADMIN_TEST_REPLY];
+  if (UNLIKELY(!ff_template_set(reply, SLOT_EXTRA, test_req_id->value, test_req_id->value_len)))
+    return false;
+
+  return send_admin(session, ADMIN_TEST_REPLY);
+}
+
+/*
+  outbound messages are not stored, the whole range is skipped with a single SequenceReset-GapFill.
+  it is sent as a possible duplicate (43=Y), so OrigSendingTime(122) is required: the current time is used.
+*/
+static bool on_resend_request(ff_session_t *restrict session, const fix_message_t *restrict message)
+{
+  const fix_field_t *const begin_field = ff_get_field(message, 7);
+
+  uint32_t begin;
+  if (UNLIKELY(!begin_field || !read_uint(begin_field, &begin) || begin == 0))
+    return false;
+
+  if (begin >= session->next_outbound)
+    return true;
+
+  char orig_sending_time[FF_TIMESTAMP_MAX_LEN];
+  const uint8_t orig_sending_time_len = ff_clock_format(&session->clock, ff_clock_now(&session->clock), orig_sending_time);
+
+  ff_template_t *const gap_fill = &session->admin[ADMIN_GAP_FILL];
+  ff_template_set_uint(gap_fill, SLOT_EXTRA, session->next_outbound);
+  ff_template_set(gap_fill, SLOT_ORIG_SENDING_TIME, orig_sending_time, orig_sending_time_len);
+  return send_template(session, gap_fill, begin);
+}
+
+//the sequence number can only move forward
+static bool on_sequence_reset(ff_session_t *restrict session, const fix_message_t *restrict message)
+{
+  const fix_field_t *const new_seq_num_field = ff_get_field(message, 36);
+
+  uint32_t new_seq_num;
+  if (UNLIKELY(!new_seq_num_field || !read_uint(new_seq_num_field, &new_seq_num)))
+    return false;
+
+  if (UNLIKELY(new_seq_num < session->next_inbound))
+    return false;
+
+  session->next_inbound = new_seq_num;
+  session->resend_pending = false;
+  return true;
+}
+
+static bool send_admin(ff_session_t *session, const admin_message_t type)
+{
+  return send_template(session, &session->admin[type], session->next_outbound++);
+}
+
+static bool send_template(ff_session_t *restrict session, ff_template_t *restrict tpl, const uint32_t seq_num)
+{
+  const int64_t now = ff_clock_now(&session->clock);
+
+  char sending_time[FF_TIMESTAMP_MAX_LEN];
+  const uint8_t sending_time_len = ff_clock_format(&session->clock, now, sending_time);
+
+  ff_template_set_uint(tpl, FF_SESSION_SLOT_SEQ_NUM, seq_num);
+  ff_template_set(tpl, FF_SESSION_SLOT_SENDING_TIME, sending_time, sending_time_len);
+
+  const char *message;
+  const uint16_t len = ff_template_finalize(tpl, &message);
+
+  session->last_sent = now;
+  return send_all(session->fd, message, len);
+}
+
+static bool send_all(const int32_t fd, const char *restrict buffer, uint16_t len)
+{
+  while (len)
+  {
+    const ssize_t sent = send(fd, buffer, len, MSG_NOSIGNAL);
+    if (UNLIKELY(sent < 0))
+    {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+
+    buffer += sent;
+    len -= sent;
+  }
+
+  return true;
+}
@@ -0,0 +1,133 @@
+/*================================================================================
+
+File: stream.c                                                                  
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:19:23                                                 
+last edited: 2026-10-17 07:47:40                                                
+
+================================================================================*/
+
+#include "common.h"
+#include "stream.h"
+#include "deserializer.h"
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t resync(const ff_stream_t *stream);
+
+bool ff_stream_create(ff_stream_t *stream, const uint32_t capacity)
+{
+  const uint32_t aligned_capacity = (capacity + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1);
+
+  *stream = (ff_stream_t){
+    .buffer = aligned_alloc(BLOCK_SIZE, aligned_capacity),
+    .capacity = aligned_capacity,
+    .head = 0,
+    .tail = 0,
+    .rejected = 0
+  };
+
+  return !!stream->buffer;
+}
+
+void ff_stream_destroy(ff_stream_t *stream)
+{
+  free(stream->buffer);
+  *stream = (ff_stream_t){0};
+}
+
+char *ff_stream_recv_buffer(ff_stream_t *restrict stream, uint32_t *restrict available)
+{
+  const uint32_t leftover = stream->tail - stream->head;
+
+  if (LIKELY(stream->head))
+  {
+    memmove(stream->buffer, stream->buffer + stream->head, leftover);
+    stream->head = 0;
+    stream->tail = leftover;
+  }
+
+  *available = stream->capacity - stream->tail;
+  return stream->buffer + stream->tail;
+}
+
+void ff_stream_commit(ff_stream_t *stream, const uint32_t len)
+{
+  stream->tail += len;
+}
+
+uint16_t ff_stream_deserialize(ff_stream_t *restrict stream, fix_message_t *restrict messages, const uint16_t max_messages, uint32_t *restrict consumed)
+{
+  const uint32_t head_start = stream->head;
+  uint16_t message_count = 0;
+  stream->rejected = 0;
+
+  while (LIKELY(message_count < max_messages && stream->head < stream->tail))
+  {
+    char *const buffer = stream->buffer + stream->head;
+    const uint32_t remaining = stream->tail - stream->head;
+    const uint16_t len = (remaining > UINT16_MAX) ? UINT16_MAX : remaining;
+
+    fix_message_t *const message = &messages[message_count];
+    const uint16_t max_fields = message->field_count;
+
+    const uint16_t message_len = ff_deserialize(buffer, len, message);
+    if (LIKELY(message_len))
+    {
+      stream->head += message_len;
+      message_count++;
+      continue;
+    }
+    message->field_count = max_fields;
+
+    //a valid message that didn't fit is kept at head, to be deserialized again with more fields or skipped
+    const uint16_t rejected = rejected_length(buffer, len, !(message->flags & FF_KEEP_DELIMITERS));
+    if (UNLIKELY(rejected))
+    {
+      stream->rejected = rejected;
+      break;
+    }
+
+    const int32_t message_end = get_checksum_offset(buffer, len) + STR_LEN("10=000\x01");
+    bool incomplete = (message_end == STR_LEN("10=000\x01")) | (message_end > len);
+    incomplete &= (message_end <= (int64_t)stream->capacity);
+    if (incomplete)
+      break;
+
+    stream->head = resync(stream);
+  }
+
+  *consumed = stream->head - head_start;
+
+  if (stream->head == stream->tail)
+    stream->head = stream->tail = 0;
+
+  return message_count;
+}
+
+//drops the message ff_stream_deserialize stopped at
+void ff_stream_skip(ff_stream_t *stream)
+{
+  stream->head += stream->rejected;
+  stream->rejected = 0;
+
+  if (stream->head == stream->tail)
+    stream->head = stream->tail = 0;
+}
+
+//skips corrupted bytes up to the next "8=FIX", keeping a tail that could be the start of a split one
+static uint32_t resync(const ff_stream_t *stream)
+{
+  const char *const start = stream->buffer + stream->head + 1;
+  const char *const end = stream->buffer + stream->tail;
+  const char *const candidate = find_begin_string(start, end);
+
+  if (LIKELY(candidate))
+    return candidate - stream->buffer;
+
+  const uint32_t kept = STR_LEN("8=FIX") - 1;
+  const uint32_t next = stream->head + 1;
+  return (stream->tail - next > kept) ? stream->tail - kept : next;
+}
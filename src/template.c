@@ -0,0 +1,221 @@
+/*================================================================================
+
+File: template.c                                                                
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:42:04                                                 
+last edited: 2026-10-17 08:34:12                                                
+
+================================================================================*/
+
+#include "common.h"
+#include "template.h"
+#include "serializer.h"
+#include <string.h>
+
+static int8_t find_slot(const ff_slot_def_t *restrict defs, const uint8_t def_count, const uint32_t tag);
+static void resize_slot(ff_template_t *restrict tpl, ff_template_slot_t *restrict slot, const uint8_t len);
+static inline void update_slot_sum(ff_template_t *restrict tpl, ff_template_slot_t *restrict slot);
+static inline bool is_uint(const char *restrict value, const uint16_t len);
+static void render_header(ff_template_t *restrict tpl, const uint16_t body_len);
+
+/*
+  renders the body of message once, reserving width bytes for the value of each slot.
+  the header is written at finalize time, right aligned before the body, so BodyLength can change width without moving it.
+  slot i is the field with tag defs[i].tag.
+*/
+bool ff_template_create(ff_template_t *restrict tpl, char *restrict buffer, const uint16_t capacity, const fix_message_t *restrict message, const ff_slot_def_t *restrict defs, const uint8_t def_count)
+{
+  if (UNLIKELY(def_count > FF_TEMPLATE_MAX_SLOTS))
+    return false;
+
+  *tpl = (ff_template_t){
+    .buffer = buffer,
+    .capacity = capacity,
+    .slot_count = def_count
+  };
+
+  const char *const limit = buffer + capacity - STR_LEN("10=000\x01");
+  char *cursor = buffer + FF_TEMPLATE_HEADER_SIZE;
+  uint16_t growth = 0;
+
+  for (uint16_t i = 0; LIKELY(i < message->field_count); i++)
+  {
+    const fix_field_t *const field = &message->fields[i];
+    const int8_t slot_index = find_slot(defs, def_count, tag_to_uint(field->tag, field->tag_len));
+    const uint16_t value_len = (slot_index < 0 || defs[slot_index].variable) ? field->value_len : defs[slot_index].width;
+
+    if (UNLIKELY(cursor + field->tag_len + value_len + STR_LEN("=\x01") > limit))
+      return false;
+
+    memcpy(cursor, field->tag, field->tag_len);
+    cursor += field->tag_len;
+    *cursor++ = '=';
+
+    if (slot_index >= 0)
+    {
+      const ff_slot_def_t *const def = &defs[slot_index];
+      ff_template_slot_t *const slot = &tpl->slots[slot_index];
+
+      if (UNLIKELY(slot->width || field->value_len > def->width))
+        return false;
+
+      //fixed width slots are zero padded on the left, which only leaves integers unchanged
+      const uint8_t padding = value_len - field->value_len;
+      if (UNLIKELY(padding && !is_uint(field->value, field->value_len)))
+        return false;
+
+      memset(cursor, '0', padding);
+
+      *slot = (ff_template_slot_t){
+        .offset = cursor - buffer,
+        .len = value_len,
+        .width = def->width,
+        .variable = def->variable,
+        .sum = 0
+      };
+
+      growth += def->width - value_len;
+      cursor += padding;
+    }
+
+    memcpy(cursor, field->value, field->value_len);
+    cursor += field->value_len;
+    *cursor++ = '\x01';
+  }
+
+  for (uint8_t i = 0; i < def_count; i++)
+  {
+    ff_template_slot_t *const slot = &tpl->slots[i];
+    if (UNLIKELY(!slot->width))
+      return false;
+
+    slot->sum = compute_checksum(buffer + slot->offset, buffer + slot->offset + slot->len);
+  }
+
+  if (UNLIKELY(cursor + growth > limit))
+    return false;
+
+  tpl->body_end = cursor - buffer;
+  tpl->body_sum = compute_checksum(buffer + FF_TEMPLATE_HEADER_SIZE, cursor);
+  return true;
+}
+
+//fixed width slots take exactly width bytes, variable ones up to width
+bool ff_template_set(ff_template_t *restrict tpl, const uint8_t slot_index, const char *restrict value, const uint8_t len)
+{
+  if (UNLIKELY(slot_index >= tpl->slot_count))
+    return false;
+
+  ff_template_slot_t *const slot = &tpl->slots[slot_index];
+
+  const bool valid = slot->variable ? (len <= slot->width) : (len == slot->width);
+  if (UNLIKELY(!valid))
+    return false;
+
+  if (UNLIKELY(len != slot->len))
+    resize_slot(tpl, slot, len);
+
+  memcpy(tpl->buffer + slot->offset, value, len);
+  update_slot_sum(tpl, slot);
+  return true;
+}
+
+//fixed width slots are zero padded
+bool ff_template_set_uint(ff_template_t *restrict tpl, const uint8_t slot_index, const uint64_t value)
+{
+  if (UNLIKELY(slot_index >= tpl->slot_count))
+    return false;
+
+  ff_template_slot_t *const slot = &tpl->slots[slot_index];
+
+  const uint8_t digits = count_digits(value);
+  if (UNLIKELY(digits > slot->width))
+    return false;
+
+  const uint8_t len = slot->variable ? digits : slot->width;
+  if (UNLIKELY(len != slot->len))
+    resize_slot(tpl, slot, len);
+
+  char *const start = tpl->buffer + slot->offset;
+  memset(start, '0', len - digits);
+  ff_encode_uint(start + len - digits, value);
+
+  update_slot_sum(tpl, slot);
+  return true;
+}
+
+//writes header and checksum around the current body, only the bytes that changed were summed since the last call
+uint16_t ff_template_finalize(ff_template_t *restrict tpl, const char **restrict message)
+{
+  const uint16_t body_len = tpl->body_end - FF_TEMPLATE_HEADER_SIZE;
+  if (UNLIKELY(body_len != tpl->body_len))
+    render_header(tpl, body_len);
+
+  const uint8_t checksum = tpl->header_sum + tpl->body_sum;
+  char *const trailer = tpl->buffer + tpl->body_end;
+
+  memcpy4(trailer, "10=0");
+  trailer[3] += checksum / 100;
+  memcpy2(trailer + 4, digit_pairs + ((checksum % 100) << 1));
+  trailer[6] = '\x01';
+
+  *message = tpl->buffer + FF_TEMPLATE_HEADER_SIZE - tpl->header_len;
+  return tpl->header_len + body_len + STR_LEN("10=000\x01");
+}
+
+static int8_t find_slot(const ff_slot_def_t *restrict defs, const uint8_t def_count, const uint32_t tag)
+{
+  for (uint8_t i = 0; i < def_count; i++)
+  {
+    if (defs[i].tag == tag)
+      return i;
+  }
+
+  return -1;
+}
+
+//moves everything after the slot, the moved bytes keep their sum
+static void resize_slot(ff_template_t *restrict tpl, ff_template_slot_t *restrict slot, const uint8_t len)
+{
+  const int16_t delta = len - slot->len;
+  char *const tail = tpl->buffer + slot->offset + slot->len;
+
+  memmove(tail + delta, tail, tpl->buffer + tpl->body_end - tail);
+  tpl->body_end += delta;
+
+  for (uint8_t i = 0; i < tpl->slot_count; i++)
+    tpl->slots[i].offset += (tpl->slots[i].offset > slot->offset) * delta;
+
+  slot->len = len;
+}
+
+static inline void update_slot_sum(ff_template_t *restrict tpl, ff_template_slot_t *restrict slot)
+{
+  const char *const start = tpl->buffer + slot->offset;
+  const uint8_t sum = compute_checksum(start, start + slot->len);
+
+  tpl->body_sum += sum - slot->sum;
+  slot->sum = sum;
+}
+
+static inline bool is_uint(const char *restrict value, const uint16_t len)
+{
+  for (uint16_t i = 0; i < len; i++)
+  {
+    if ((uint8_t)(value[i] - '0') > 9)
+      return false;
+  }
+
+  return true;
+}
+
+static void render_header(ff_template_t *restrict tpl, const uint16_t body_len)
+{
+  char *const body = tpl->buffer + FF_TEMPLATE_HEADER_SIZE;
+  const char *const start = prepend_header(body, body_len, &tpl->header_sum);
+
+  tpl->header_len = body - start;
+  tpl->body_len = body_len;
+}
\ No newline at end of file
@@ -0,0 +1,443 @@
+/*================================================================================
+
+File: uring.c                                                                   
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 07:15:01                                                 
+last edited: 2026-10-17 07:57:13                                                
+
+================================================================================*/
+
+#include "common.h"
+#include "uring.h"
+#include "deserializer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#define RING_ENTRIES 8
+#define BUFFER_GROUP 0
+#define CARRY_SIZE (UINT16_MAX + 1)
+#define HEADER_MAX_LEN STR_LEN("8=FIX.4.4\x01""9=65535\x01")
+#define SQ_THREAD_IDLE_MS 1000
+
+static bool map_rings(ff_uring_t *restrict uring, const struct io_uring_params *restrict params);
+static bool setup_buffers(ff_uring_t *uring);
+static bool arm_recv(ff_uring_t *uring);
+static bool next_completion(ff_uring_t *uring);
+static uint16_t complete_carry(ff_uring_t *restrict uring, char **restrict data, uint32_t *restrict remaining, fix_message_t *restrict message);
+static void resync_carry(ff_uring_t *uring);
+static void keep_tail(ff_uring_t *restrict uring, const char *restrict data, const uint32_t len);
+static inline int32_t enter(const int32_t ring_fd, const uint32_t to_submit, const uint32_t min_complete, const uint32_t flags);
+
+/*
+  a single multishot recv stays armed on the socket: the kernel picks a buffer from the provided buffer ring for each
+  completion, so receiving costs no syscall per read and no copy. with sqpoll the submissions are picked up by a kernel
+  thread, with busy_poll ff_uring_receive polls the completion queue instead of waiting in io_uring_enter.
+*/
+bool ff_uring_create(ff_uring_t *restrict uring, const int32_t fd, const ff_uring_config_t *restrict config)
+{
+  *uring = (ff_uring_t){
+    .ring_fd = -1,
+    .socket_fd = fd,
+    .sqpoll = config->sqpoll,
+    .busy_poll = config->busy_poll,
+    .buffer_size = (config->buffer_size + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1),
+    .buffer_count = config->buffer_count,
+    .current = FF_URING_NO_BUFFER
+  };
+
+  const uint16_t count = config->buffer_count;
+  if (UNLIKELY(!count || (count & (count - 1)) || count > 1 << 15 || !config->buffer_size))
+    return false;
+
+  struct io_uring_params params = {
+    .flags = config->sqpoll ? IORING_SETUP_SQPOLL : 0,
+    .sq_thread_idle = SQ_THREAD_IDLE_MS
+  };
+
+  uring->ring_fd = syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+  if (UNLIKELY(uring->ring_fd < 0))
+    return false;
+
+  const bool created = map_rings(uring, &params) && setup_buffers(uring) && arm_recv(uring);
+  if (UNLIKELY(!created))
+    ff_uring_destroy(uring);
+
+  return created;
+}
+
+void ff_uring_destroy(ff_uring_t *uring)
+{
+  if (uring->ring_fd >= 0)
+    close(uring->ring_fd);
+  if (uring->sqes)
+    munmap(uring->sqes, uring->sqes_size);
+  if (uring->cq_ring && uring->cq_ring != uring->sq_ring)
+    munmap(uring->cq_ring, uring->cq_ring_size);
+  if (uring->sq_ring)
+    munmap(uring->sq_ring, uring->sq_ring_size);
+  if (uring->buf_ring)
+    munmap(uring->buf_ring, uring->buf_ring_size);
+
+  free(uring->buffers);
+  free((uring->spare && uring->spare < uring->carry) ? uring->spare : uring->carry);
+  *uring = (ff_uring_t){ .ring_fd = -1, .socket_fd = -1, .current = FF_URING_NO_BUFFER };
+}
+
+/*
+  deserializes the messages of one received buffer in place. a message split across two buffers is completed in a
+  carry buffer, the only copy, and returned first by the next call. the buffer is not parsed while the carry holds
+  bytes, so the messages keep their order.
+  buffer_id is set once the whole buffer has been parsed: the messages returned by this call and the previous ones point
+  into it until it is released. messages in the carry buffer stay valid until the next call.
+*/
+uint16_t ff_uring_receive(ff_uring_t *restrict uring, fix_message_t *restrict messages, const uint16_t max_messages, int32_t *restrict buffer_id)
+{
+  *buffer_id = FF_URING_NO_BUFFER;
+  uring->rejected = 0;
+
+  char *data = NULL;
+  uint32_t remaining = 0;
+  uint16_t count = 0;
+
+  //a whole message can be left in the carry by the previous call, it doesn't wait for a new buffer
+  if (uring->carry_len && uring->current == FF_URING_NO_BUFFER)
+  {
+    count = complete_carry(uring, &data, &remaining, messages);
+    if (count || uring->rejected)
+      return count;
+  }
+
+  if (uring->current == FF_URING_NO_BUFFER && !next_completion(uring))
+    return 0;
+
+  data = uring->buffers + (size_t)uring->current * uring->buffer_size + uring->current_offset;
+  remaining = uring->current_len - uring->current_offset;
+
+  if (uring->carry_len)
+    count = complete_carry(uring, &data, &remaining, messages);
+
+  while (LIKELY(count < max_messages && remaining && !uring->carry_len))
+  {
+    fix_message_t *const message = &messages[count];
+    const uint16_t max_fields = message->field_count;
+    const uint16_t len = (remaining > UINT16_MAX) ? UINT16_MAX : remaining;
+
+    const uint16_t message_len = ff_deserialize(data, len, message);
+    if (LIKELY(message_len))
+    {
+      data += message_len;
+      remaining -= message_len;
+      count++;
+      continue;
+    }
+    message->field_count = max_fields;
+
+    //a valid message that didn't fit is kept, to be deserialized again with more fields or skipped
+    const uint16_t rejected = rejected_length(data, len, !(message->flags & FF_KEEP_DELIMITERS));
+    if (UNLIKELY(rejected))
+    {
+      uring->rejected = rejected;
+      break;
+    }
+
+    const int32_t checksum_offset = get_checksum_offset(data, len);
+    const bool incomplete = (checksum_offset == 0) || (checksum_offset > 0 && checksum_offset + STR_LEN("10=000\x01") > remaining);
+    if (incomplete)
+    {
+      keep_tail(uring, data, remaining);
+      remaining = 0;
+      break;
+    }
+
+    //corrupted bytes are skipped up to the next "8=FIX", a tail that could be the start of one is kept
+    const char *const next = find_begin_string(data + 1, data + remaining);
+    const uint32_t kept = STR_LEN("8=FIX") - 1;
+    const uint32_t skipped = next ? (uint32_t)(next - data) : (remaining > kept ? remaining - kept : remaining);
+    data += skipped;
+    remaining -= skipped;
+  }
+
+  if (remaining)
+  {
+    uring->current_offset = uring->current_len - remaining;
+    return count;
+  }
+
+  *buffer_id = uring->current;
+  uring->current = FF_URING_NO_BUFFER;
+  return count;
+}
+
+//drops the message ff_uring_receive stopped at, the carry only holds bytes that come before the current buffer
+void ff_uring_skip(ff_uring_t *uring)
+{
+  if (uring->carry_len)
+  {
+    uring->carry_len -= uring->rejected;
+    memmove(uring->carry, uring->carry + uring->rejected, uring->carry_len);
+  }
+  else
+    uring->current_offset += uring->rejected;
+
+  uring->rejected = 0;
+}
+
+//hands the buffer back to the kernel, the messages pointing into it must not be used anymore
+void ff_uring_release(ff_uring_t *uring, const int32_t buffer_id)
+{
+  if (buffer_id == FF_URING_NO_BUFFER)
+    return;
+
+  struct io_uring_buf_ring *const ring = uring->buf_ring;
+  struct io_uring_buf *const buf = &ring->bufs[uring->buf_tail & (uring->buffer_count - 1)];
+
+  buf->addr = (uint64_t)(uintptr_t)(uring->buffers + (size_t)buffer_id * uring->buffer_size);
+  buf->len = uring->buffer_size;
+  buf->bid = buffer_id;
+
+  __atomic_store_n(&ring->tail, ++uring->buf_tail, __ATOMIC_RELEASE);
+  uring->held--;
+
+  if (UNLIKELY(!uring->armed) && !uring->closed)
+    uring->closed = !arm_recv(uring);
+}
+
+static bool map_rings(ff_uring_t *restrict uring, const struct io_uring_params *restrict params)
+{
+  uring->sq_ring_size = params->sq_off.array + params->sq_entries * sizeof(uint32_t);
+  uring->cq_ring_size = params->cq_off.cqes + params->cq_entries * sizeof(struct io_uring_cqe);
+  uring->sqes_size = params->sq_entries * sizeof(struct io_uring_sqe);
+
+  const bool single_mmap = params->features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap)
+    uring->sq_ring_size = uring->cq_ring_size = (uring->sq_ring_size > uring->cq_ring_size) ? uring->sq_ring_size : uring->cq_ring_size;
+
+  void *const sq_ring = mmap(NULL, uring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_SQ_RING);
+  if (UNLIKELY(sq_ring == MAP_FAILED))
+    return false;
+  uring->sq_ring = sq_ring;
+
+  void *const cq_ring = single_mmap ? sq_ring : mmap(NULL, uring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_CQ_RING);
+  if (UNLIKELY(cq_ring == MAP_FAILED))
+    return false;
+  uring->cq_ring = cq_ring;
+
+  void *const sqes = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_SQES);
+  if (UNLIKELY(sqes == MAP_FAILED))
+    return false;
+  uring->sqes = sqes;
+
+  uring->sq_tail = (uint32_t *)((char *)sq_ring + params->sq_off.tail);
+  uring->sq_flags = (uint32_t *)((char *)sq_ring + params->sq_off.flags);
+  uring->sq_array = (uint32_t *)((char *)sq_ring + params->sq_off.array);
+  uring->sq_mask = *(uint32_t *)((char *)sq_ring + params->sq_off.ring_mask);
+  uring->cq_head = (uint32_t *)((char *)cq_ring + params->cq_off.head);
+  uring->cq_tail = (uint32_t *)((char *)cq_ring + params->cq_off.tail);
+  uring->cq_mask = *(uint32_t *)((char *)cq_ring + params->cq_off.ring_mask);
+  uring->cqes = (char *)cq_ring + params->cq_off.cqes;
+  return true;
+}
+
+//the buffers are block aligned, so the deserializer can load whole blocks around them
+static bool setup_buffers(ff_uring_t *uring)
+{
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  uring->buf_ring_size = (uring->buffer_count * sizeof(struct io_uring_buf) + page_size - 1) & ~(page_size - 1);
+
+  void *const buf_ring = mmap(NULL, uring->buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (UNLIKELY(buf_ring == MAP_FAILED))
+    return false;
+  uring->buf_ring = buf_ring;
+
+  uring->buffers = aligned_alloc(BLOCK_SIZE, (size_t)uring->buffer_count * uring->buffer_size);
+  uring->carry = aligned_alloc(BLOCK_SIZE, 2 * CARRY_SIZE);
+  if (UNLIKELY(!uring->buffers || !uring->carry))
+    return false;
+  uring->spare = uring->carry + CARRY_SIZE;
+
+  struct io_uring_buf_reg reg = {
+    .ring_addr = (uint64_t)(uintptr_t)buf_ring,
+    .ring_entries = uring->buffer_count,
+    .bgid = BUFFER_GROUP
+  };
+  if (UNLIKELY(syscall(__NR_io_uring_register, uring->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0))
+    return false;
+
+  //the initial buffers are released as if the application held them, without submitting the recv
+  uring->armed = true;
+  uring->held = uring->buffer_count;
+  for (uint16_t i = 0; i < uring->buffer_count; i++)
+    ff_uring_release(uring, i);
+  uring->armed = false;
+
+  return true;
+}
+
+//armed again whenever the kernel ends the multishot, e.g. when it ran out of buffers
+static bool arm_recv(ff_uring_t *uring)
+{
+  const uint32_t tail = *uring->sq_tail;
+  const uint32_t index = tail & uring->sq_mask;
+  struct io_uring_sqe *const sqe = (struct io_uring_sqe *)uring->sqes + index;
+
+  *sqe = (struct io_uring_sqe){
+    .opcode = IORING_OP_RECV,
+    .fd = uring->socket_fd,
+    .ioprio = IORING_RECV_MULTISHOT,
+    .flags = IOSQE_BUFFER_SELECT,
+    .buf_group = BUFFER_GROUP
+  };
+  uring->sq_array[index] = index;
+  __atomic_store_n(uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+  uring->armed = true;
+
+  if (!uring->sqpoll)
+    return enter(uring->ring_fd, 1, 0, 0) >= 0;
+
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(uring->sq_flags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP)
+    return enter(uring->ring_fd, 0, 0, IORING_ENTER_SQ_WAKEUP) >= 0;
+
+  return true;
+}
+
+static bool next_completion(ff_uring_t *uring)
+{
+  while (LIKELY(!uring->closed))
+  {
+    const uint32_t head = *uring->cq_head;
+    if (head == __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE))
+    {
+      if (uring->busy_poll)
+        return false;
+
+      if (UNLIKELY(enter(uring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR))
+        uring->closed = true;
+      continue;
+    }
+
+    const struct io_uring_cqe *const cqe = (const struct io_uring_cqe *)uring->cqes + (head & uring->cq_mask);
+    const int32_t res = cqe->res;
+    const uint32_t flags = cqe->flags;
+    __atomic_store_n(uring->cq_head, head + 1, __ATOMIC_RELEASE);
+
+    /*
+      0 is the peer closing the connection, -ENOBUFS means the ring was empty. if the application still holds every
+      buffer, recv is armed again by the first release.
+    */
+    if (UNLIKELY(res <= 0))
+    {
+      uring->closed = (res != -ENOBUFS);
+      uring->armed = (flags & IORING_CQE_F_MORE);
+      if (!uring->closed && !uring->armed && uring->held < uring->buffer_count)
+        uring->closed = !arm_recv(uring);
+      return false;
+    }
+
+    if (UNLIKELY(!(flags & IORING_CQE_F_MORE)))
+      uring->closed = !arm_recv(uring);
+
+    uring->held++;
+    uring->current = flags >> IORING_CQE_BUFFER_SHIFT;
+    uring->current_offset = 0;
+    uring->current_len = res;
+    return true;
+  }
+
+  return false;
+}
+
+/*
+  the message is completed in the carry buffer, reading BodyLength first to copy no more than it needs.
+  bytes that turn out not to be a message are dropped up to the next "8=FIX" inside the carry, the bytes after a message
+  completed there are kept for the next call.
+*/
+static uint16_t complete_carry(ff_uring_t *restrict uring, char **restrict data, uint32_t *restrict remaining, fix_message_t *restrict message)
+{
+  while (uring->carry_len)
+  {
+    const int32_t checksum_offset = get_checksum_offset(uring->carry, uring->carry_len);
+    const uint32_t total = checksum_offset ? checksum_offset + STR_LEN("10=000\x01") : HEADER_MAX_LEN;
+    const bool invalid = (checksum_offset < 0) || (total > UINT16_MAX) || (!checksum_offset && uring->carry_len >= HEADER_MAX_LEN);
+    if (UNLIKELY(invalid))
+    {
+      resync_carry(uring);
+      continue;
+    }
+
+    if (uring->carry_len < total)
+    {
+      if (!*remaining)
+        return 0;
+
+      const uint32_t missing = total - uring->carry_len;
+      const uint32_t len = (missing < *remaining) ? missing : *remaining;
+
+      memcpy(uring->carry + uring->carry_len, *data, len);
+      uring->carry_len += len;
+      *data += len;
+      *remaining -= len;
+      continue;
+    }
+
+    const uint16_t max_fields = message->field_count;
+    if (LIKELY(ff_deserialize(uring->carry, total, message) == total))
+    {
+      const uint32_t leftover = uring->carry_len - total;
+      if (leftover)
+        keep_tail(uring, uring->carry + total, leftover);
+      else
+        uring->carry_len = 0;
+      return 1;
+    }
+    message->field_count = max_fields;
+
+    const uint16_t rejected = rejected_length(uring->carry, total, !(message->flags & FF_KEEP_DELIMITERS));
+    if (UNLIKELY(rejected))
+    {
+      uring->rejected = rejected;
+      return 0;
+    }
+
+    resync_carry(uring);
+  }
+
+  return 0;
+}
+
+//same as the resync of the received buffers, a tail that could be the start of "8=FIX" is kept
+static void resync_carry(ff_uring_t *uring)
+{
+  const char *const next = find_begin_string(uring->carry + 1, uring->carry + uring->carry_len);
+  const uint32_t kept = STR_LEN("8=FIX") - 1;
+  const uint32_t skipped = next ? (uint32_t)(next - uring->carry) : (uring->carry_len > kept ? uring->carry_len - kept : uring->carry_len);
+
+  uring->carry_len -= skipped;
+  memmove(uring->carry, uring->carry + skipped, uring->carry_len);
+}
+
+//the tail goes in the spare carry buffer, the message completed in the current one is still in use
+static void keep_tail(ff_uring_t *restrict uring, const char *restrict data, const uint32_t len)
+{
+  if (UNLIKELY(len > CARRY_SIZE))
+    return;
+
+  char *const carry = uring->spare;
+  uring->spare = uring->carry;
+  uring->carry = carry;
+
+  memcpy(carry, data, len);
+  uring->carry_len = len;
+}
+
+static inline int32_t enter(const int32_t ring_fd, const uint32_t to_submit, const uint32_t min_complete, const uint32_t flags)
+{
+  return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
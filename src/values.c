@@ -0,0 +1,190 @@
+/*================================================================================
+
+File: values.c                                                                  
+Creator: Claudio Raimondi                                                       
+Email: claudio.raimondi@pm.me                                                   
+
+created at: 2026-10-17 06:34:41                                                 
+last edited: 2026-10-17 08:32:55                                                
+
+================================================================================*/
+
+#include "common.h"
+#include "values.h"
+#include "lookup.h"
+#include <string.h>
+
+static inline uint64_t parse_digits(const char *digits, const uint8_t len, bool *restrict valid);
+static inline int32_t days_from_civil(const uint16_t year, const uint8_t month, const uint8_t day);
+static inline uint8_t days_in_month(const uint16_t year, const uint8_t month);
+
+/*
+  converts a FIX decimal ([-]digits[.digits]) to a fixed-point integer with scale decimal places.
+  fails if the value has more decimals than scale or doesn't fit in FF_DECIMAL_MAX_DIGITS digits once scaled.
+*/
+bool ff_decode_decimal(const char *restrict value, const uint16_t value_len, const uint8_t scale, int64_t *restrict result)
+{
+  const char *const end = value + value_len;
+
+  const bool negative = (value_len > 0) & (*value == '-');
+  value += negative;
+
+  //values are a few bytes long, a plain loop beats the call to memchr
+  const char *int_end = value;
+  while (int_end < end && *int_end != '.')
+    int_end++;
+
+  const char *const frac = int_end + (int_end < end);
+
+  const uint16_t int_len = int_end - value;
+  const uint16_t frac_len = end - frac;
+
+  bool valid = (int_len + frac_len > 0);
+  valid &= (frac_len <= scale);
+  valid &= (int_len + scale <= FF_DECIMAL_MAX_DIGITS);
+  if (UNLIKELY(!valid))
+    return false;
+
+  const uint64_t int_part = parse_digits(value, int_len, &valid);
+  const uint64_t frac_part = parse_digits(frac, frac_len, &valid);
+  if (UNLIKELY(!valid))
+    return false;
+
+  const uint64_t magnitude = int_part * powers_of_10[scale] + frac_part * powers_of_10[scale - frac_len];
+  *result = negative ? -(int64_t)magnitude : (int64_t)magnitude;
+  return true;
+}
+
+/*
+  decodes the first occurrence of each tag, bit i of the result is set if tags[i] was found and decoded into results[i].
+  the mask has room for 64 tags, the ones past the 64th are left undecoded.
+*/
+uint64_t ff_decode_decimals(const fix_message_t *restrict message, const uint32_t *restrict tags, const uint8_t *restrict scales, int64_t *restrict results, const uint8_t count)
+{
+  const uint8_t decodable = (count < 64) ? count : 64;
+  uint64_t decoded = 0;
+
+  for (uint8_t i = 0; i < decodable; i++)
+  {
+    const fix_field_t *const field = ff_get_field(message, tags[i]);
+    if (UNLIKELY(!field))
+      continue;
+
+    decoded |= (uint64_t)ff_decode_decimal(field->value, field->value_len, scales[i], &results[i]) << i;
+  }
+
+  return decoded;
+}
+
+/*
+  converts a UTCTimestamp (YYYYMMDD-HH:MM:SS with an optional fraction of 3, 6 or 9 digits) to nanoseconds since the epoch.
+  the value is copied over a '0' padded layout, so every precision is parsed as nanoseconds by the same kernel.
+*/
+bool ff_decode_timestamp(const char *restrict value, const uint16_t value_len, int64_t *restrict result)
+{
+  bool valid = (value_len == STR_LEN("YYYYMMDD-HH:MM:SS"));
+  valid |= (value_len == STR_LEN("YYYYMMDD-HH:MM:SS.sss"));
+  valid |= (value_len == STR_LEN("YYYYMMDD-HH:MM:SS.ssssss"));
+  valid |= (value_len == STR_LEN("YYYYMMDD-HH:MM:SS.sssssssss"));
+  if (UNLIKELY(!valid))
+    return false;
+
+  char timestamp[TIMESTAMP_SIZE] ALIGNED(TIMESTAMP_SIZE);
+  memcpy(timestamp, "00000000-00:00:00.00000000000000", TIMESTAMP_SIZE);
+  memcpy(timestamp, value, value_len);
+
+  timestamp_t parts;
+  if (UNLIKELY(!parse_timestamp(timestamp, &parts)))
+    return false;
+
+  //int64 nanoseconds overflow in 2262
+  valid = (parts.year >= 1970) & (parts.year < 2262);
+  valid &= (parts.month - 1U < 12);
+  valid &= (parts.day - 1U < days_in_month(parts.year, parts.month));
+  valid &= (parts.hour < 24) & (parts.minute < 60) & (parts.second <= 60);
+  if (UNLIKELY(!valid))
+    return false;
+
+  const int64_t seconds = (int64_t)days_from_civil(parts.year, parts.month, parts.day) * 86400 + parts.hour * 3600 + parts.minute * 60 + parts.second;
+  *result = seconds * 1000000000LL + parts.nanosecond;
+  return true;
+}
+
+//converts a UTCTimeOnly (HH:MM:SS with an optional fraction of 3, 6 or 9 digits) to nanoseconds since midnight
+bool ff_decode_time(const char *restrict value, const uint16_t value_len, int64_t *restrict result)
+{
+  bool valid = (value_len == STR_LEN("HH:MM:SS"));
+  valid |= (value_len == STR_LEN("HH:MM:SS.sss"));
+  valid |= (value_len == STR_LEN("HH:MM:SS.ssssss"));
+  valid |= (value_len == STR_LEN("HH:MM:SS.sssssssss"));
+  if (UNLIKELY(!valid))
+    return false;
+
+  char timestamp[TIMESTAMP_SIZE] ALIGNED(TIMESTAMP_SIZE);
+  memcpy(timestamp, "19700101-00:00:00.00000000000000", TIMESTAMP_SIZE);
+  memcpy(timestamp + STR_LEN("YYYYMMDD-"), value, value_len);
+
+  timestamp_t parts;
+  if (UNLIKELY(!parse_timestamp(timestamp, &parts)))
+    return false;
+
+  valid = (parts.hour < 24) & (parts.minute < 60) & (parts.second <= 60);
+  if (UNLIKELY(!valid))
+    return false;
+
+  *result = (parts.hour * 3600 + parts.minute * 60 + parts.second) * 1000000000LL + parts.nanosecond;
+  return true;
+}
+
+//8 digits at a time, the remainder is right aligned over a '0' padded chunk so the same SWAR step applies
+static inline uint64_t parse_digits(const char *digits, const uint8_t len, bool *restrict valid)
+{
+  uint64_t result = 0;
+  uint8_t remaining = len;
+
+  while (remaining >= sizeof(uint64_t))
+  {
+    uint64_t chunk;
+    memcpy(&chunk, digits, sizeof(chunk));
+    chunk -= 0x3030303030303030ULL;
+
+    *valid &= swar_is_digits(chunk);
+    result = result * powers_of_10[8] + swar_combine8(chunk);
+
+    digits += sizeof(uint64_t);
+    remaining -= sizeof(uint64_t);
+  }
+
+  if (remaining)
+  {
+    //copied rather than loaded: the bytes before the digits belong to the previous field or to another allocation
+    uint64_t chunk = 0x3030303030303030ULL;
+    memcpy((char *)&chunk + sizeof(chunk) - remaining, digits, remaining);
+    chunk -= 0x3030303030303030ULL;
+
+    *valid &= swar_is_digits(chunk);
+    result = result * powers_of_10[remaining] + swar_combine8(chunk);
+  }
+
+  return result;
+}
+
+//days since 1970-01-01 of a proleptic gregorian date, counting eras of 400 years starting from march
+static inline int32_t days_from_civil(const uint16_t year, const uint8_t month, const uint8_t day)
+{
+  const int32_t y = year - (month <= 2);
+  const int32_t era = y / 400;
+  const uint32_t year_of_era = y - era * 400;
+  const uint32_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const uint32_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+  return era * 146097 + (int32_t)day_of_era - 719468;
+}
+
+static inline uint8_t days_in_month(const uint16_t year, const uint8_t month)
+{
+  static const uint8_t days[13] = { 0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+  const bool leap = ((year % 4 == 0) & (year % 100 != 0)) | (year % 400 == 0);
+  return days[month % 13] + ((month == 2) & leap);
+}
\ No newline at end of file
@@ -5,7 +5,7 @@ Creator: Claudio Raimondi
 Email: claudio.raimondi@pm.me                                                   
 
 created at: 2025-02-10 21:08:13                                                 
-last edited: 2025-03-02 12:33:40                                                
+last edited: 2026-10-17 08:35:49                                                
 
 ================================================================================*/
 
@@ -16,6 +16,11 @@ last edited: 2025-03-02 12:33:40
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 #define STR_LEN(str)  (sizeof(str) - 1)
 #define ARR_SIZE(arr) (sizeof(arr) / sizeof(arr[0]))
@@ -48,6 +53,8 @@ static bool compare_messages(const fix_message_t *a, const fix_message_t *b)
 static char *all_tests(void);
 static char *test_serialize_normal_message(void);
 static char *test_serialize_one_field_message(void);
+static char *test_serialize_long_values(void);
+static char *test_serialize_reserved(void);
 static char *test_serialize_raw_normal_message(void);
 static char *test_serialize_raw_one_field_message(void);
 static char *test_deserialize_normal_message(void);
@@ -59,8 +66,43 @@ static char *test_deserialize_wrong_body_length1(void);
 static char *test_deserialize_wrong_body_length2(void);
 static char *test_deserialize_checksum_mismatch(void);
 static char *test_deserialize_no_body(void);
+static char *test_deserialize_equals_in_value(void);
+static char *test_deserialize_missing_equals(void);
+static char *test_deserialize_const(void);
+static char *test_deserialize_batch(void);
+static char *test_deserialize_incremental_split_message(void);
+static char *test_deserialize_incremental_checksum_mismatch(void);
 static char *test_is_complete_positive(void);
 static char *test_is_complete_negative(void);
+static char *test_is_complete_partial_header(void);
+static char *test_is_complete_trailing_bytes(void);
+static char *test_is_complete_malformed_header(void);
+static char *test_stream_multiple_messages(void);
+static char *test_stream_resync(void);
+static char *test_stream_rejected(void);
+static char *test_dispatch_isa(void);
+static char *test_get_field_index(void);
+static char *test_get_field_no_index(void);
+static char *test_deserialize_parse_tags(void);
+static char *test_decode_decimal(void);
+static char *test_decode_decimals(void);
+static char *test_decode_timestamp(void);
+static char *test_decode_time(void);
+static char *test_encode_integers(void);
+static char *test_encode_decimal(void);
+static char *test_encode_double(void);
+static char *test_clock_format(void);
+static char *test_clock_now(void);
+static char *test_template_message(void);
+static char *test_get_groups(void);
+static char *test_serialize_groups(void);
+static char *test_decode_md_incremental(void);
+static char *test_compact_round_trip(void);
+static char *test_session(void);
+static char *test_uring_receive(void);
+static char *test_batch_send(void);
+static char *test_journal(void);
+static char *test_capture_parse(void);
 
 int main(void)
 {
@@ -80,6 +122,8 @@ static char *all_tests(void)
 {
   mu_run_test(test_serialize_normal_message);
   mu_run_test(test_serialize_one_field_message);
+  mu_run_test(test_serialize_long_values);
+  mu_run_test(test_serialize_reserved);
 
   mu_run_test(test_serialize_raw_normal_message);
   mu_run_test(test_serialize_raw_one_field_message);
@@ -93,9 +137,53 @@ static char *all_tests(void)
   mu_run_test(test_deserialize_wrong_body_length2);
   mu_run_test(test_deserialize_checksum_mismatch);
   mu_run_test(test_deserialize_no_body);
+  mu_run_test(test_deserialize_equals_in_value);
+  mu_run_test(test_deserialize_missing_equals);
+  mu_run_test(test_deserialize_const);
+
+  mu_run_test(test_deserialize_batch);
+
+  mu_run_test(test_deserialize_incremental_split_message);
+  mu_run_test(test_deserialize_incremental_checksum_mismatch);
 
   mu_run_test(test_is_complete_positive);
   mu_run_test(test_is_complete_negative);
+  mu_run_test(test_is_complete_partial_header);
+  mu_run_test(test_is_complete_trailing_bytes);
+  mu_run_test(test_is_complete_malformed_header);
+
+  mu_run_test(test_stream_multiple_messages);
+  mu_run_test(test_stream_resync);
+  mu_run_test(test_stream_rejected);
+
+  mu_run_test(test_dispatch_isa);
+
+  mu_run_test(test_get_field_index);
+  mu_run_test(test_get_field_no_index);
+
+  mu_run_test(test_deserialize_parse_tags);
+
+  mu_run_test(test_decode_decimal);
+  mu_run_test(test_decode_decimals);
+  mu_run_test(test_decode_timestamp);
+  mu_run_test(test_decode_time);
+
+  mu_run_test(test_encode_integers);
+  mu_run_test(test_encode_decimal);
+  mu_run_test(test_encode_double);
+
+  mu_run_test(test_clock_format);
+  mu_run_test(test_clock_now);
+  mu_run_test(test_template_message);
+  mu_run_test(test_get_groups);
+  mu_run_test(test_serialize_groups);
+  mu_run_test(test_decode_md_incremental);
+  mu_run_test(test_compact_round_trip);
+  mu_run_test(test_session);
+  mu_run_test(test_uring_receive);
+  mu_run_test(test_batch_send);
+  mu_run_test(test_journal);
+  mu_run_test(test_capture_parse);
 
   return 0;
 }
@@ -112,7 +200,7 @@ static char *test_serialize_normal_message(void)
     { .tag = "98", .value = "0", .tag_len = 2, .value_len = 1 },
     { .tag = "108", .value = "30", .tag_len = 3, .value_len = 2 }
   };
-  const fix_message_t message = { fields, 8 };
+  const fix_message_t message = { .fields = fields, .field_count = 8 };
   constexpr char expected_buffer[] =
     "8=FIX.4.4\x01"
     "9=73\x01"
@@ -141,7 +229,7 @@ static char *test_serialize_one_field_message(void)
   fix_field_t fields[1] = {
     { .tag = "6", .value = "123", .tag_len = 1, .value_len = 3 }
   };
-  const fix_message_t message = { fields, 1 };
+  const fix_message_t message = { .fields = fields, .field_count = 1 };
   constexpr char expected_buffer[] =
     "8=FIX.4.4\x01"
     "9=6\x01"
@@ -158,6 +246,69 @@ static char *test_serialize_one_field_message(void)
   return 0;
 }
 
+//values of every length up to 130 bytes go through all the copy widths of the serializer
+static char *test_serialize_long_values(void)
+{
+  char value[130];
+  for (uint8_t i = 0; i < sizeof(value); i++)
+    value[i] = 'A' + (i * 7) % 58;
+
+  fix_field_t fields[2] = {
+    { .tag = "35", .value = "D", .tag_len = 2, .value_len = 1 },
+    { .tag = "58", .value = value, .tag_len = 2, .value_len = 0 }
+  };
+  const fix_message_t message = { .fields = fields, .field_count = 2 };
+
+  char buffer[256];
+  fix_field_t parsed_fields[4];
+
+  for (uint8_t len = 1; len <= sizeof(value); len++)
+  {
+    fields[1].value_len = len;
+    const uint16_t serialized_len = ff_serialize(buffer, &message);
+
+    fix_message_t parsed = { .fields = parsed_fields, .field_count = 4 };
+    mu_assert("error: serialize long values: wrong checksum", ff_deserialize(buffer, serialized_len, &parsed) == serialized_len);
+    mu_assert("error: serialize long values: wrong value", parsed.fields[1].value_len == len && memcmp(parsed.fields[1].value, value, len) == 0);
+  }
+
+  return 0;
+}
+
+static char *test_serialize_reserved(void)
+{
+  char value[1200];
+  memset(value, 'X', sizeof(value));
+
+  fix_field_t fields[3] = {
+    { .tag = "35", .value = "0", .tag_len = 2, .value_len = 1 },
+    { .tag = "34", .value = "12", .tag_len = 2, .value_len = 2 },
+    { .tag = "58", .value = value, .tag_len = 2, .value_len = 0 }
+  };
+
+  char expected_buffer[1300];
+  char buffer[1300];
+  uint16_t len;
+
+  //BodyLength from 1 to 4 digits
+  constexpr uint16_t value_lens[] = { 0, 1, 90, 1100 };
+  for (uint8_t i = 0; i < sizeof(value_lens) / sizeof(value_lens[0]); i++)
+  {
+    fields[2].value_len = value_lens[i];
+    const uint16_t n_fields = i ? 3 : 1;
+    const fix_message_t message = { .fields = fields, .field_count = n_fields };
+
+    const uint16_t expected_len = ff_serialize(expected_buffer, &message);
+    const char *start = ff_serialize_reserved(buffer, &message, &len);
+
+    mu_assert("error: serialize reserved: wrong length", len == expected_len);
+    mu_assert("error: serialize reserved: wrong buffer", memcmp(start, expected_buffer, len) == 0);
+    mu_assert("error: serialize reserved: body moved", memcmp(buffer + FF_HEADER_RESERVED_LEN, "35=0\x01", 5) == 0);
+  }
+
+  return 0;
+}
+
 static char *test_serialize_raw_normal_message(void)
 {
   fix_field_t fields[8] = {
@@ -170,7 +321,7 @@ static char *test_serialize_raw_normal_message(void)
     { .tag = "98", .value = "0", .tag_len = 2, .value_len = 1 },
     { .tag = "108", .value = "30", .tag_len = 3, .value_len = 2 }
   };
-  const fix_message_t message = { fields, 8 };
+  const fix_message_t message = { .fields = fields, .field_count = 8 };
   constexpr char expected_buffer[] =
     "6=123\x01"
     "35=D\x01"
@@ -196,7 +347,7 @@ static char *test_serialize_raw_one_field_message(void)
   fix_field_t fields[1] = {
     { .tag = "6", .value = "123", .tag_len = 1, .value_len = 3 }
   };
-  const fix_message_t message = { fields, 1 };
+  const fix_message_t message = { .fields = fields, .field_count = 1 };
   constexpr char expected_buffer[] =
     "6=123\x01";
   constexpr uint16_t expected_len = STR_LEN(expected_buffer);
@@ -234,12 +385,12 @@ static char *test_deserialize_normal_message(void)
     { .tag = "98", .value = "0", .tag_len = 2, .value_len = 1 },
     { .tag = "108", .value = "30", .tag_len = 3, .value_len = 2 }
   };
-  const fix_message_t expected_message = { expected_fields, 8 };
+  const fix_message_t expected_message = { .fields = expected_fields, .field_count = 8 };
   constexpr uint16_t expected_len = STR_LEN(buffer);
 
 
   fix_field_t fields[ARR_SIZE(expected_fields)];
-  fix_message_t message = { fields, ARR_SIZE(fields) };
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
   uint16_t len = ff_deserialize(buffer, sizeof(buffer), &message);
 
   mu_assert("error: deserialize normal message: wrong length", len == expected_len);
@@ -322,7 +473,7 @@ static char *test_deserialize_too_many_fields(void)
   constexpr uint16_t expected_len = 0;
 
   fix_field_t fields[64];
-  fix_message_t message = { fields, ARR_SIZE(fields) };
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
   uint16_t len = ff_deserialize(buffer, sizeof(buffer), &message);
 
   mu_assert("error: deserialize too many fields: wrong length", len == expected_len);
@@ -345,7 +496,7 @@ static char *test_deserialize_no_beginstr(void)
   constexpr uint16_t expected_len = 0;
 
   fix_field_t fields[7];
-  fix_message_t message = { fields, ARR_SIZE(fields) };
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
   uint16_t len = ff_deserialize(buffer, sizeof(buffer), &message);
 
   mu_assert("error: deserialize no begin string: wrong length", len == expected_len);
@@ -368,7 +519,7 @@ static char *test_deserialize_no_body_length(void)
   constexpr uint16_t expected_len = 0;
 
   fix_field_t fields[7];
-  fix_message_t message = { fields, ARR_SIZE(fields) };
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
   uint16_t len = ff_deserialize(buffer, sizeof(buffer), &message);
 
   mu_assert("error: deserialize no body length: wrong length", len == expected_len);
@@ -392,7 +543,7 @@ static char *test_deserialize_wrong_beginstr(void)
   constexpr uint16_t expected_len = 0;
 
   fix_field_t fields[7];
-  fix_message_t message = { fields, ARR_SIZE(fields) };
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
   uint16_t len = ff_deserialize(buffer, sizeof(buffer), &message);
 
   mu_assert("error: deserialize wrong beginstr: wrong length", len == expected_len);
@@ -416,7 +567,7 @@ static char *test_deserialize_wrong_body_length1(void)
   constexpr uint16_t expected_len = 0;
 
   fix_field_t fields[7];
-  fix_message_t message = { fields, ARR_SIZE(fields) };
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
   uint16_t len = ff_deserialize(buffer, sizeof(buffer), &message);
 
   mu_assert("error: deserialize wrong bodylength 1: wrong length", len == expected_len);
@@ -440,7 +591,7 @@ static char *test_deserialize_wrong_body_length2(void)
   constexpr uint16_t expected_len = 0;
 
   fix_field_t fields[7];
-  fix_message_t message = { fields, ARR_SIZE(fields) };
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
   uint16_t len = ff_deserialize(buffer, sizeof(buffer), &message);
 
   mu_assert("error: deserialize wrong bodylength 2: wrong length", len == expected_len);
@@ -464,7 +615,7 @@ static char *test_deserialize_checksum_mismatch(void)
   constexpr uint16_t expected_len = 0;
 
   fix_field_t fields[7];
-  fix_message_t message = { fields, ARR_SIZE(fields) };
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
   uint16_t len = ff_deserialize(buffer, sizeof(buffer), &message);
 
   mu_assert("error: deserialize checksum mismatch: wrong length", len == expected_len);
@@ -479,11 +630,11 @@ static char *test_deserialize_no_body(void)
     "9=0\x01"
     "10=200\x01";
   fix_field_t expected_fields[1] = {0};
-  fix_message_t expected_message = { expected_fields, 0 };
+  fix_message_t expected_message = { .fields = expected_fields, .field_count = 0 };
   constexpr uint16_t expected_len = STR_LEN(buffer);
 
   fix_field_t fields[1] = {0};
-  fix_message_t message = { fields, ARR_SIZE(fields) };
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
   uint16_t len = ff_deserialize(buffer, sizeof(buffer), &message);
 
   mu_assert("error: deserialize no body: wrong length", len == expected_len);
@@ -492,6 +643,167 @@ static char *test_deserialize_no_body(void)
   return 0;
 }
 
+static char *test_deserialize_equals_in_value(void)
+{
+  char buffer[] = 
+    "8=FIX.4.4\x01"
+    "9=24\x01"
+    "35=D\x01"
+    "58=a=b=c\x01"
+    "55=EURUSD\x01"
+    "10=179\x01";
+  fix_field_t expected_fields[3] = {
+    { .tag = "35", .value = "D", .tag_len = 2, .value_len = 1 },
+    { .tag = "58", .value = "a=b=c", .tag_len = 2, .value_len = 5 },
+    { .tag = "55", .value = "EURUSD", .tag_len = 2, .value_len = 6 }
+  };
+  const fix_message_t expected_message = { .fields = expected_fields, .field_count = 3 };
+  constexpr uint16_t expected_len = STR_LEN(buffer);
+
+  fix_field_t fields[ARR_SIZE(expected_fields)];
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
+  uint16_t len = ff_deserialize(buffer, sizeof(buffer), &message);
+
+  mu_assert("error: deserialize equals in value: wrong length", len == expected_len);
+  mu_assert("error: deserialize equals in value: wrong message", compare_messages(&message, &expected_message));
+
+  return 0;
+}
+
+static char *test_deserialize_missing_equals(void)
+{
+  char buffer[] = 
+    "8=FIX.4.4\x01"
+    "9=18\x01"
+    "35=D\x01"
+    "58\x01"
+    "55=EURUSD\x01"
+    "10=217\x01";
+  constexpr uint16_t expected_len = 0;
+
+  fix_field_t fields[3];
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
+  uint16_t len = ff_deserialize(buffer, sizeof(buffer), &message);
+
+  mu_assert("error: deserialize missing equals: wrong length", len == expected_len);
+
+  return 0;
+}
+
+static char *test_deserialize_batch(void)
+{
+  char long_message[] =
+    "8=FIX.4.4\x01"
+    "9=73\x01"
+    "6=123\x01"
+    "35=D\x01"
+    "49=BROKER\x01"
+    "56=CLIENT\x01"
+    "34=1\x01"
+    "52=20250210-18:52:11.000\x01"
+    "98=0\x01"
+    "108=30\x01"
+    "10=127\x01";
+  char short_message[] = "8=FIX.4.4\x01""9=6\x01""6=123\x01""10=216\x01";
+  char heartbeat[] = "8=FIX.4.4\x01""9=5\x01""35=0\x01""10=163\x01";
+  char corrupted[] = "8=FIX.4.4\x01""9=6\x01""6=124\x01""10=216\x01";
+  char short_message_copy[] = "8=FIX.4.4\x01""9=6\x01""6=123\x01""10=216\x01";
+  char *const buffers[] = { long_message, short_message, heartbeat, corrupted, short_message_copy };
+  const uint16_t buffer_sizes[] = { sizeof(long_message), sizeof(short_message), sizeof(heartbeat), sizeof(corrupted), sizeof(short_message_copy) };
+  const uint16_t expected_lengths[] = { STR_LEN(long_message), STR_LEN(short_message), STR_LEN(heartbeat), 0, STR_LEN(short_message_copy) };
+
+  fix_field_t fields[ARR_SIZE(buffers)][8];
+  fix_message_t messages[ARR_SIZE(buffers)];
+  uint16_t lengths[ARR_SIZE(buffers)];
+
+  for (uint8_t i = 0; i < ARR_SIZE(buffers); i++)
+    messages[i] = (fix_message_t){ .fields = fields[i], .field_count = ARR_SIZE(fields[i]) };
+
+  const uint16_t deserialized = ff_deserialize_batch(buffers, buffer_sizes, messages, lengths, ARR_SIZE(buffers));
+
+  mu_assert("error: deserialize batch: wrong count", deserialized == 4);
+  for (uint8_t i = 0; i < ARR_SIZE(buffers); i++)
+    mu_assert("error: deserialize batch: wrong length", lengths[i] == expected_lengths[i]);
+  mu_assert("error: deserialize batch: wrong first message", messages[0].field_count == 8 && strcmp(messages[0].fields[7].value, "30") == 0);
+  mu_assert("error: deserialize batch: wrong last message", messages[4].field_count == 1 && strcmp(messages[4].fields[0].value, "123") == 0);
+
+  return 0;
+}
+
+static char *test_deserialize_incremental_split_message(void)
+{
+  char buffer[] = 
+    "8=FIX.4.4\x01"
+    "9=73\x01"
+    "6=123\x01"
+    "35=D\x01"
+    "49=BROKER\x01"
+    "56=CLIENT\x01"
+    "34=1\x01"
+    "52=20250210-18:52:11.000\x01"
+    "98=0\x01"
+    "108=30\x01"
+    "10=127\x01";
+  fix_field_t expected_fields[8] = {
+    { .tag = "6", .value = "123", .tag_len = 1, .value_len = 3 },
+    { .tag = "35", .value = "D", .tag_len = 2, .value_len = 1 },
+    { .tag = "49", .value = "BROKER", .tag_len = 2, .value_len = 6 },
+    { .tag = "56", .value = "CLIENT", .tag_len = 2, .value_len = 6 },
+    { .tag = "34", .value = "1", .tag_len = 2, .value_len = 1 },
+    { .tag = "52", .value = "20250210-18:52:11.000", .tag_len = 2, .value_len = 21 },
+    { .tag = "98", .value = "0", .tag_len = 2, .value_len = 1 },
+    { .tag = "108", .value = "30", .tag_len = 3, .value_len = 2 }
+  };
+  const fix_message_t expected_message = { .fields = expected_fields, .field_count = 8 };
+  constexpr uint16_t expected_len = STR_LEN(buffer);
+  constexpr uint16_t chunk_ends[] = { 11, 30, 60, expected_len - 3, expected_len };
+
+  fix_field_t fields[ARR_SIZE(expected_fields)];
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
+  ff_parser_t parser = {0};
+  uint16_t len = 0;
+
+  for (uint8_t i = 0; i < ARR_SIZE(chunk_ends); i++)
+  {
+    len = ff_deserialize_incremental(&parser, buffer, chunk_ends[i], &message);
+    mu_assert("error: deserialize incremental split message: early result", (len == 0) == (i < ARR_SIZE(chunk_ends) - 1));
+  }
+
+  mu_assert("error: deserialize incremental split message: wrong length", len == expected_len);
+  mu_assert("error: deserialize incremental split message: wrong state", parser.state == FF_PARSER_DONE);
+  mu_assert("error: deserialize incremental split message: wrong message", compare_messages(&message, &expected_message));
+
+  return 0;
+}
+
+static char *test_deserialize_incremental_checksum_mismatch(void)
+{
+  char buffer[] = 
+    "8=FIX.4.4\x01"
+    "9=67\x01"
+    "35=D\x01"
+    "49=BROKER\x01"
+    "56=CLIENT\x01"
+    "34=1\x01"
+    "52=20250210-18:52:11.000\x01"
+    "98=0\x01"
+    "108=31\x01"
+    "10=255\x01";
+  constexpr uint16_t total_len = STR_LEN(buffer);
+
+  fix_field_t fields[7];
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
+  ff_parser_t parser = {0};
+
+  uint16_t len = ff_deserialize_incremental(&parser, buffer, 40, &message);
+  len |= ff_deserialize_incremental(&parser, buffer, total_len, &message);
+
+  mu_assert("error: deserialize incremental checksum mismatch: wrong length", len == 0);
+  mu_assert("error: deserialize incremental checksum mismatch: wrong state", parser.state == FF_PARSER_ERROR);
+
+  return 0;
+}
+
 static char *test_is_complete_positive(void)
 {
   char buffer[] = 
@@ -529,4 +841,1248 @@ static char *test_is_complete_negative(void)
   mu_assert("error: is complete negative: wrong result", !ff_is_complete(buffer, len));
 
   return 0;
-}
\ No newline at end of file
+}
+
+static char *test_is_complete_partial_header(void)
+{
+  char buffer[] = 
+    "8=FIX.4.4\x01"
+    "9=6";
+  constexpr uint16_t len = STR_LEN(buffer);
+
+  mu_assert("error: is complete partial header: wrong result", !ff_is_complete(buffer, len));
+
+  return 0;
+}
+
+static char *test_is_complete_trailing_bytes(void)
+{
+  char buffer[] = 
+    "8=FIX.4.4\x01"
+    "9=6\x01"
+    "6=123\x01"
+    "10=216\x01"
+    "8=FIX.4.4\x01"
+    "9=";
+  constexpr uint16_t len = STR_LEN(buffer);
+
+  mu_assert("error: is complete trailing bytes: wrong result", ff_is_complete(buffer, len));
+
+  return 0;
+}
+
+static char *test_is_complete_malformed_header(void)
+{
+  char buffer[] = 
+    "9=67\x01"
+    "35=D\x01"
+    "49=BROKER\x01"
+    "56=CLIENT\x01"
+    "34=1\x01"
+    "52=20250210-18:52:11.000\x01"
+    "98=0\x01"
+    "108=30\x01"
+    "10=087\x01";
+  constexpr uint16_t len = STR_LEN(buffer);
+
+  mu_assert("error: is complete malformed header: wrong result", ff_is_complete(buffer, len));
+
+  return 0;
+}
+
+static char *test_stream_multiple_messages(void)
+{
+  constexpr char first_read[] =
+    "8=FIX.4.4\x01""9=6\x01""6=123\x01""10=216\x01"
+    "8=FIX.4.4\x01""9=5\x01""35=0\x01""10=163\x01"
+    "8=FIX.4.4\x01""9=6\x01""6=1";
+  constexpr char second_read[] =
+    "23\x01""10=216\x01";
+  constexpr uint32_t expected_consumed = 2 * STR_LEN("8=FIX.4.4\x01""9=6\x01""6=123\x01""10=216\x01") - 1;
+
+  ff_stream_t stream;
+  mu_assert("error: stream multiple messages: create failed", ff_stream_create(&stream, 256));
+
+  fix_field_t fields[4][2];
+  fix_message_t messages[4] = {
+    { .fields = fields[0], .field_count = 2 },
+    { .fields = fields[1], .field_count = 2 },
+    { .fields = fields[2], .field_count = 2 },
+    { .fields = fields[3], .field_count = 2 },
+  };
+  uint32_t available;
+  uint32_t consumed;
+
+  char *buffer = ff_stream_recv_buffer(&stream, &available);
+  memcpy(buffer, first_read, STR_LEN(first_read));
+  ff_stream_commit(&stream, STR_LEN(first_read));
+  const uint16_t first_count = ff_stream_deserialize(&stream, messages, ARR_SIZE(messages), &consumed);
+
+  mu_assert("error: stream multiple messages: wrong first count", first_count == 2);
+  mu_assert("error: stream multiple messages: wrong consumed", consumed == expected_consumed);
+  mu_assert("error: stream multiple messages: wrong second message", messages[1].field_count == 1 && strcmp(messages[1].fields[0].value, "0") == 0);
+
+  buffer = ff_stream_recv_buffer(&stream, &available);
+  memcpy(buffer, second_read, STR_LEN(second_read));
+  ff_stream_commit(&stream, STR_LEN(second_read));
+  const uint16_t second_count = ff_stream_deserialize(&stream, messages, ARR_SIZE(messages), &consumed);
+
+  mu_assert("error: stream multiple messages: wrong second count", second_count == 1);
+  mu_assert("error: stream multiple messages: wrong third message", strcmp(messages[0].fields[0].value, "123") == 0);
+  mu_assert("error: stream multiple messages: not drained", stream.head == 0 && stream.tail == 0);
+
+  ff_stream_destroy(&stream);
+
+  return 0;
+}
+
+static char *test_stream_resync(void)
+{
+  constexpr char data[] =
+    "garbage\x01"
+    "8=FIX.4.4\x01""9=6\x01""6=123\x01""10=216\x01"
+    "8=FIX.4.4\x01""9=6\x01""6=123\x01""10=999\x01"
+    "8=FI\x01"
+    "8=FIX.4.4\x01""9=5\x01""35=0\x01""10=163\x01";
+
+  ff_stream_t stream;
+  mu_assert("error: stream resync: create failed", ff_stream_create(&stream, 256));
+
+  fix_field_t fields[4][2];
+  fix_message_t messages[4] = {
+    { .fields = fields[0], .field_count = 2 },
+    { .fields = fields[1], .field_count = 2 },
+    { .fields = fields[2], .field_count = 2 },
+    { .fields = fields[3], .field_count = 2 },
+  };
+  uint32_t available;
+  uint32_t consumed;
+
+  char *buffer = ff_stream_recv_buffer(&stream, &available);
+  memcpy(buffer, data, STR_LEN(data));
+  ff_stream_commit(&stream, STR_LEN(data));
+  const uint16_t count = ff_stream_deserialize(&stream, messages, ARR_SIZE(messages), &consumed);
+
+  mu_assert("error: stream resync: wrong count", count == 2);
+  mu_assert("error: stream resync: wrong consumed", consumed == STR_LEN(data));
+  mu_assert("error: stream resync: wrong first message", strcmp(messages[0].fields[0].value, "123") == 0);
+  mu_assert("error: stream resync: wrong second message", strcmp(messages[1].fields[0].tag, "35") == 0);
+
+  ff_stream_destroy(&stream);
+
+  return 0;
+}
+
+static char *test_stream_rejected(void)
+{
+  constexpr char data[] =
+    "8=FIX.4.4\x01""9=6\x01""6=123\x01""10=216\x01"
+    "8=FIX.4.4\x01""9=14\x01""6=1\x01""35=0\x01""98=0\x01""10=087\x01"
+    "8=FIX.4.4\x01""9=5\x01""35=0\x01""10=163\x01";
+  constexpr uint16_t first_len = STR_LEN("8=FIX.4.4\x01""9=6\x01""6=123\x01""10=216\x01");
+  constexpr uint16_t rejected_len = STR_LEN("8=FIX.4.4\x01""9=14\x01""6=1\x01""35=0\x01""98=0\x01""10=000\x01");
+
+  ff_stream_t stream;
+  mu_assert("error: stream rejected: create failed", ff_stream_create(&stream, 256));
+
+  fix_field_t fields[2][3];
+  fix_message_t messages[2] = {
+    { .fields = fields[0], .field_count = 2 },
+    { .fields = fields[1], .field_count = 2 },
+  };
+  uint32_t available;
+  uint32_t consumed;
+
+  char *buffer = ff_stream_recv_buffer(&stream, &available);
+  memcpy(buffer, data, STR_LEN(data));
+  ff_stream_commit(&stream, STR_LEN(data));
+
+  uint16_t count = ff_stream_deserialize(&stream, messages, ARR_SIZE(messages), &consumed);
+  mu_assert("error: stream rejected: valid message skipped", count == 1 && consumed == first_len);
+  mu_assert("error: stream rejected: not reported", stream.rejected == rejected_len && stream.head == first_len);
+
+  //the message is left intact, so it can be deserialized with more fields
+  messages[0].field_count = 3;
+  count = ff_stream_deserialize(&stream, messages, 1, &consumed);
+  mu_assert("error: stream rejected: retry failed", count == 1 && stream.rejected == 0 && messages[0].field_count == 3);
+  mu_assert("error: stream rejected: wrong retried message", strcmp(messages[0].fields[2].tag, "98") == 0);
+
+  ff_stream_destroy(&stream);
+  mu_assert("error: stream rejected: create failed", ff_stream_create(&stream, 256));
+
+  buffer = ff_stream_recv_buffer(&stream, &available);
+  memcpy(buffer, data, STR_LEN(data));
+  ff_stream_commit(&stream, STR_LEN(data));
+
+  messages[0].field_count = 2;
+  count = ff_stream_deserialize(&stream, messages, ARR_SIZE(messages), &consumed);
+  ff_stream_skip(&stream);
+  messages[0].field_count = 2;
+  count = ff_stream_deserialize(&stream, messages, ARR_SIZE(messages), &consumed);
+  mu_assert("error: stream rejected: skip failed", count == 1 && strcmp(messages[0].fields[0].tag, "35") == 0);
+  mu_assert("error: stream rejected: not drained", stream.head == 0 && stream.tail == 0);
+
+  ff_stream_destroy(&stream);
+
+  return 0;
+}
+
+static char *test_dispatch_isa(void)
+{
+  const char *const isa = ff_isa();
+  const char *const forced = getenv("FLASHFIX_ISA");
+
+  bool known = false;
+  known |= strcmp(isa, "generic") == 0;
+  known |= strcmp(isa, "sse4") == 0;
+  known |= strcmp(isa, "avx2") == 0;
+  known |= strcmp(isa, "avx512") == 0;
+
+  mu_assert("error: dispatch isa: unknown tier", known);
+  //every cpu supports the generic tier, so forcing it must always be honoured
+  const bool forced_generic = forced && strcmp(forced, "generic") == 0;
+  mu_assert("error: dispatch isa: override ignored", !forced_generic || strcmp(isa, "generic") == 0);
+
+  return 0;
+}
+
+static char *test_get_field_index(void)
+{
+  char buffer[] = "8=FIX.4.4\x01""9=24\x01""35=D\x01""9001=X\x01""55=AB\x01""55=CD\x01""10=162\x01";
+  char heartbeat[] = "8=FIX.4.4\x01""9=5\x01""35=0\x01""10=163\x01";
+
+  fix_tag_index_t index = {0};
+  fix_field_t fields[4];
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields), .index = &index };
+
+  mu_assert("error: get field index: deserialize failed", ff_deserialize(buffer, STR_LEN(buffer), &message) == STR_LEN(buffer));
+  mu_assert("error: get field index: wrong direct field", ff_get_field(&message, 35) == &fields[0]);
+  mu_assert("error: get field index: wrong hashed field", ff_get_field(&message, 9001) == &fields[1]);
+  mu_assert("error: get field index: duplicate not first", ff_get_field(&message, 55) == &fields[2]);
+  mu_assert("error: get field index: missing field found", ff_get_field(&message, 11) == NULL);
+  mu_assert("error: get field index: wrong presence", index.presence == ((1ULL << 35) | (1ULL << 55)));
+
+  message.field_count = ARR_SIZE(fields);
+  mu_assert("error: get field index: reuse failed", ff_deserialize(heartbeat, STR_LEN(heartbeat), &message) == STR_LEN(heartbeat));
+  mu_assert("error: get field index: stale direct field", ff_get_field(&message, 55) == NULL);
+  mu_assert("error: get field index: stale hashed field", ff_get_field(&message, 9001) == NULL);
+  mu_assert("error: get field index: wrong field after reuse", strcmp(ff_get_field(&message, 35)->value, "0") == 0);
+
+  //an index that was never filled by a deserialization is not trusted
+  fix_tag_index_t unused = {0};
+  message.index = &unused;
+  mu_assert("error: get field index: unused index matched", ff_get_field(&message, 55) == NULL && ff_get_field(&message, 35) == &fields[0]);
+
+  return 0;
+}
+
+static char *test_get_field_no_index(void)
+{
+  char buffer[] = "8=FIX.4.4\x01""9=24\x01""35=D\x01""9001=X\x01""55=AB\x01""55=CD\x01""10=162\x01";
+
+  fix_field_t fields[4];
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
+
+  mu_assert("error: get field no index: deserialize failed", ff_deserialize(buffer, STR_LEN(buffer), &message) == STR_LEN(buffer));
+  mu_assert("error: get field no index: wrong field", ff_get_field(&message, 9001) == &fields[1]);
+  mu_assert("error: get field no index: duplicate not first", ff_get_field(&message, 55) == &fields[2]);
+  mu_assert("error: get field no index: missing field found", ff_get_field(&message, 11) == NULL);
+
+  return 0;
+}
+
+static char *test_deserialize_parse_tags(void)
+{
+  char buffer[] = "8=FIX.4.4\x01""9=47\x01""35=D\x01""55=AB\x01""10000=1\x01""12345678=2\x01""123456789=3\x01""A1=4\x01""10=190\x01";
+  const uint32_t expected_tags[] = { 35, 55, 10000, 12345678, 123456789, 0 };
+
+  fix_field_t fields[ARR_SIZE(expected_tags)];
+  fix_message_t message = { fields, ARR_SIZE(fields), NULL, FF_PARSE_TAGS };
+
+  mu_assert("error: deserialize parse tags: deserialize failed", ff_deserialize(buffer, STR_LEN(buffer), &message) == STR_LEN(buffer));
+  mu_assert("error: deserialize parse tags: wrong field count", message.field_count == ARR_SIZE(expected_tags));
+
+  for (uint16_t i = 0; i < message.field_count; i++)
+    mu_assert("error: deserialize parse tags: wrong tag number", fields[i].tag_num == expected_tags[i]);
+
+  return 0;
+}
+
+static char *test_decode_decimal(void)
+{
+  int64_t result;
+
+  mu_assert("error: decode decimal: integer", ff_decode_decimal("1500", 4, 0, &result) && result == 1500);
+  mu_assert("error: decode decimal: negative", ff_decode_decimal("-1.5", 4, 2, &result) && result == -150);
+  mu_assert("error: decode decimal: leading point", ff_decode_decimal(".5", 2, 1, &result) && result == 5);
+  mu_assert("error: decode decimal: small", ff_decode_decimal("0.00012345", 10, 8, &result) && result == 12345);
+  mu_assert("error: decode decimal: 18 digits", ff_decode_decimal("123456789012.345678", 19, 6, &result) && result == 123456789012345678LL);
+  mu_assert("error: decode decimal: too many decimals", !ff_decode_decimal("12.345", 6, 2, &result));
+  mu_assert("error: decode decimal: too many digits", !ff_decode_decimal("1234567890123", 13, 6, &result));
+  mu_assert("error: decode decimal: not a number", !ff_decode_decimal("1e3", 3, 0, &result));
+  mu_assert("error: decode decimal: two points", !ff_decode_decimal("1.2.3", 5, 4, &result));
+  mu_assert("error: decode decimal: sign only", !ff_decode_decimal("-", 1, 0, &result));
+
+  return 0;
+}
+
+static char *test_decode_decimals(void)
+{
+  char buffer[] = "8=FIX.4.4\x01""9=26\x01""44=-101.25\x01""38=1500\x01""31=1e3\x01""10=212\x01";
+  const uint32_t tags[] = { 44, 38, 31, 14 };
+  const uint8_t scales[] = { 4, 0, 4, 0 };
+  int64_t results[ARR_SIZE(tags)] = {0};
+
+  fix_tag_index_t index = {0};
+  fix_field_t fields[4];
+  fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields), .index = &index };
+
+  mu_assert("error: decode decimals: deserialize failed", ff_deserialize(buffer, STR_LEN(buffer), &message) == STR_LEN(buffer));
+
+  const uint64_t decoded = ff_decode_decimals(&message, tags, scales, results, ARR_SIZE(tags));
+
+  mu_assert("error: decode decimals: wrong decoded mask", decoded == 0b0011);
+  mu_assert("error: decode decimals: wrong price", results[0] == -1012500);
+  mu_assert("error: decode decimals: wrong quantity", results[1] == 1500);
+
+  uint32_t many_tags[65];
+  uint8_t many_scales[65] = {0};
+  int64_t many_results[65] = {0};
+  for (uint8_t i = 0; i < ARR_SIZE(many_tags); i++)
+    many_tags[i] = 38;
+
+  const uint64_t many_decoded = ff_decode_decimals(&message, many_tags, many_scales, many_results, ARR_SIZE(many_tags));
+  mu_assert("error: decode decimals: wrong mask past 64 tags", many_decoded == ~0ULL);
+  mu_assert("error: decode decimals: decoded past 64 tags", many_results[63] == 1500 && many_results[64] == 0);
+
+  return 0;
+}
+
+static char *test_decode_timestamp(void)
+{
+  int64_t result;
+
+  mu_assert("error: decode timestamp: seconds", ff_decode_timestamp("20250210-18:52:11", 17, &result) && result == 1739213531000000000LL);
+  mu_assert("error: decode timestamp: milliseconds", ff_decode_timestamp("20250210-18:52:11.123", 21, &result) && result == 1739213531123000000LL);
+  mu_assert("error: decode timestamp: microseconds", ff_decode_timestamp("20240229-23:59:59.123456", 24, &result) && result == 1709251199123456000LL);
+  mu_assert("error: decode timestamp: nanoseconds", ff_decode_timestamp("20991231-00:00:00.987654321", 27, &result) && result == 4102358400987654321LL);
+  mu_assert("error: decode timestamp: wrong length", !ff_decode_timestamp("20250210-18:52:11.12", 20, &result));
+  mu_assert("error: decode timestamp: wrong separator", !ff_decode_timestamp("20250210-18-52:11.123", 21, &result));
+  mu_assert("error: decode timestamp: not a digit", !ff_decode_timestamp("2025021a-18:52:11.123", 21, &result));
+  mu_assert("error: decode timestamp: not a leap year", !ff_decode_timestamp("20250229-18:52:11", 17, &result));
+  mu_assert("error: decode timestamp: wrong hour", !ff_decode_timestamp("20250210-24:00:00", 17, &result));
+
+  return 0;
+}
+
+static char *test_decode_time(void)
+{
+  int64_t result = 0;
+
+  mu_assert("error: decode time: seconds", ff_decode_time("14:30:01", 8, &result) && result == 52201000000000LL);
+  mu_assert("error: decode time: millis", ff_decode_time("14:30:01.250", 12, &result) && result == 52201250000000LL);
+  mu_assert("error: decode time: nanos", ff_decode_time("00:00:00.000000007", 18, &result) && result == 7);
+  mu_assert("error: decode time: hour out of range", !ff_decode_time("24:00:00", 8, &result));
+  mu_assert("error: decode time: bad separator", !ff_decode_time("14-30:01", 8, &result));
+  mu_assert("error: decode time: bad length", !ff_decode_time("14:30:01.2", 10, &result));
+
+  return 0;
+}
+
+static char *test_encode_integers(void)
+{
+  char buffer[FF_MAX_ENCODED_LEN];
+  uint8_t len;
+
+  len = ff_encode_uint(buffer, 0);
+  mu_assert("error: encode integers: zero", len == 1 && memcmp(buffer, "0", len) == 0);
+  len = ff_encode_uint(buffer, 100);
+  mu_assert("error: encode integers: power of 10", len == 3 && memcmp(buffer, "100", len) == 0);
+  len = ff_encode_uint(buffer, UINT64_MAX);
+  mu_assert("error: encode integers: uint64 max", len == 20 && memcmp(buffer, "18446744073709551615", len) == 0);
+  len = ff_encode_int(buffer, -7);
+  mu_assert("error: encode integers: negative", len == 2 && memcmp(buffer, "-7", len) == 0);
+  len = ff_encode_int(buffer, INT64_MIN);
+  mu_assert("error: encode integers: int64 min", len == 20 && memcmp(buffer, "-9223372036854775808", len) == 0);
+
+  return 0;
+}
+
+static char *test_encode_decimal(void)
+{
+  char buffer[FF_MAX_ENCODED_LEN];
+  uint8_t len;
+  int64_t decoded;
+
+  len = ff_encode_decimal(buffer, 1012500, 4);
+  mu_assert("error: encode decimal: trailing zeros", len == 6 && memcmp(buffer, "101.25", len) == 0);
+  len = ff_encode_decimal(buffer, -5, 3);
+  mu_assert("error: encode decimal: leading zeros", len == 6 && memcmp(buffer, "-0.005", len) == 0);
+  len = ff_encode_decimal(buffer, 1500, 2);
+  mu_assert("error: encode decimal: integer", len == 2 && memcmp(buffer, "15", len) == 0);
+  len = ff_encode_decimal(buffer, 123456789012345678LL, 6);
+  mu_assert("error: encode decimal: round trip", ff_decode_decimal(buffer, len, 6, &decoded) && decoded == 123456789012345678LL);
+  len = ff_encode_decimal(buffer, 1, FF_ENCODE_MAX_SCALE + 1);
+  mu_assert("error: encode decimal: scale out of range", len == 0);
+
+  return 0;
+}
+
+static char *test_encode_double(void)
+{
+  char buffer[FF_MAX_ENCODED_LEN];
+  uint8_t len;
+
+  len = ff_encode_double(buffer, 101.25);
+  mu_assert("error: encode double: exact", len == 6 && memcmp(buffer, "101.25", len) == 0);
+  len = ff_encode_double(buffer, 0.1);
+  mu_assert("error: encode double: shortest", len == 3 && memcmp(buffer, "0.1", len) == 0);
+  len = ff_encode_double(buffer, -1e6);
+  mu_assert("error: encode double: integer", len == 8 && memcmp(buffer, "-1000000", len) == 0);
+
+  len = ff_encode_double(buffer, 0.1 + 0.2);
+  buffer[len] = '\0';
+  mu_assert("error: encode double: fallback round trip", len > 0 && strtod(buffer, NULL) == 0.1 + 0.2);
+  len = ff_encode_double(buffer, -1.2345678901234567e-4);
+  buffer[len] = '\0';
+  mu_assert("error: encode double: small fallback", len == 23 && strtod(buffer, NULL) == -1.2345678901234567e-4);
+
+  len = ff_encode_double(buffer, 1e300);
+  mu_assert("error: encode double: out of range", len == 0);
+
+  return 0;
+}
+
+static char *test_clock_format(void)
+{
+  ff_clock_t clock;
+  char buffer[FF_TIMESTAMP_MAX_LEN];
+  uint8_t len;
+
+  ff_clock_init(&clock, 3);
+
+  len = ff_clock_format(&clock, 1739213531123456789LL, buffer);
+  mu_assert("error: clock format: first render", len == 21 && memcmp(buffer, "20250210-18:52:11.123", len) == 0);
+  len = ff_clock_format(&clock, 1739213531999000000LL, buffer);
+  mu_assert("error: clock format: same second", len == 21 && memcmp(buffer, "20250210-18:52:11.999", len) == 0);
+  len = ff_clock_format(&clock, 1739213579000000000LL, buffer);
+  mu_assert("error: clock format: same minute", len == 21 && memcmp(buffer, "20250210-18:52:59.000", len) == 0);
+  len = ff_clock_format(&clock, 1739213580005000000LL, buffer);
+  mu_assert("error: clock format: next minute", len == 21 && memcmp(buffer, "20250210-18:53:00.005", len) == 0);
+  len = ff_clock_format(&clock, 1739232000000000000LL, buffer);
+  mu_assert("error: clock format: next day", len == 21 && memcmp(buffer, "20250211-00:00:00.000", len) == 0);
+  len = ff_clock_format(&clock, 1735689599000000000LL, buffer);
+  mu_assert("error: clock format: backwards", len == 21 && memcmp(buffer, "20241231-23:59:59.000", len) == 0);
+
+  ff_clock_init(&clock, 9);
+  len = ff_clock_format(&clock, 1739213531000000007LL, buffer);
+  mu_assert("error: clock format: nanoseconds", len == 27 && memcmp(buffer, "20250210-18:52:11.000000007", len) == 0);
+
+  ff_clock_init(&clock, 0);
+  len = ff_clock_format(&clock, 1739213531999999999LL, buffer);
+  mu_assert("error: clock format: seconds", len == 17 && memcmp(buffer, "20250210-18:52:11", len) == 0);
+
+  mu_assert("error: clock format: invalid precision accepted", !ff_clock_init(&clock, 4) && !ff_clock_init(&clock, 12));
+
+  return 0;
+}
+
+static char *test_clock_now(void)
+{
+  ff_clock_t clock;
+  struct timespec ts;
+
+  ff_clock_init(&clock, 6);
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  const int64_t expected = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+  const int64_t now = ff_clock_now(&clock);
+
+  mu_assert("error: clock now: too far from CLOCK_REALTIME", llabs(now - expected) < 5000000);
+
+  char buffer[FF_TIMESTAMP_MAX_LEN];
+  int64_t decoded;
+  const uint8_t len = ff_clock_timestamp(&clock, buffer);
+  mu_assert("error: clock now: timestamp doesn't decode", ff_decode_timestamp(buffer, len, &decoded));
+  mu_assert("error: clock now: timestamp too far", llabs(decoded - now) < 5000000);
+
+  return 0;
+}
+static char *test_template_message(void)
+{
+  fix_field_t fields[6] = {
+    { .tag = "35", .value = "D", .tag_len = 2, .value_len = 1 },
+    { .tag = "49", .value = "BROKER", .tag_len = 2, .value_len = 6 },
+    { .tag = "34", .value = "1", .tag_len = 2, .value_len = 1 },
+    { .tag = "52", .value = "20250210-18:52:11.000", .tag_len = 2, .value_len = 21 },
+    { .tag = "11", .value = "A", .tag_len = 2, .value_len = 1 },
+    { .tag = "38", .value = "100", .tag_len = 2, .value_len = 3 }
+  };
+  const fix_message_t message = { .fields = fields, .field_count = 6 };
+  const ff_slot_def_t defs[3] = {
+    { .tag = 34, .width = 6, .variable = false },
+    { .tag = 52, .width = 21, .variable = false },
+    { .tag = 11, .width = 16, .variable = true }
+  };
+
+  ff_template_t tpl;
+  char buffer[256];
+  const char *output;
+  uint16_t len;
+
+  mu_assert("error: template: create failed", ff_template_create(&tpl, buffer, sizeof(buffer), &message, defs, 3));
+
+  char expected_buffer[256];
+  fields[2].value = "000001";
+  fields[2].value_len = 6;
+  uint16_t expected_len = ff_serialize(expected_buffer, &message);
+  len = ff_template_finalize(&tpl, &output);
+  mu_assert("error: template: initial render", len == expected_len && memcmp(output, expected_buffer, len) == 0);
+
+  mu_assert("error: template: set seqnum", ff_template_set_uint(&tpl, 0, 4321));
+  mu_assert("error: template: set timestamp", ff_template_set(&tpl, 1, "20250211-09:30:00.125", 21));
+  mu_assert("error: template: set clordid", ff_template_set(&tpl, 2, "ORDER-0000000042", 16));
+  fields[2].value = "004321";
+  fields[3].value = "20250211-09:30:00.125";
+  fields[4].value = "ORDER-0000000042";
+  fields[4].value_len = 16;
+  expected_len = ff_serialize(expected_buffer, &message);
+  len = ff_template_finalize(&tpl, &output);
+  mu_assert("error: template: patched render", len == expected_len && memcmp(output, expected_buffer, len) == 0);
+
+  fix_field_t parsed_fields[8];
+  fix_message_t parsed = { .fields = parsed_fields, .field_count = 8 };
+  memcpy(expected_buffer, output, len);
+  mu_assert("error: template: doesn't deserialize", ff_deserialize(expected_buffer, len, &parsed) == len);
+  mu_assert("error: template: wrong field count", parsed.field_count == 6);
+
+  mu_assert("error: template: set shorter clordid", ff_template_set(&tpl, 2, "B", 1));
+  fields[4].value = "B";
+  fields[4].value_len = 1;
+  expected_len = ff_serialize(expected_buffer, &message);
+  len = ff_template_finalize(&tpl, &output);
+  mu_assert("error: template: shrunk render", len == expected_len && memcmp(output, expected_buffer, len) == 0);
+
+  mu_assert("error: template: fixed width accepted a short value", !ff_template_set(&tpl, 1, "2025", 4));
+  mu_assert("error: template: variable slot accepted a long value", !ff_template_set(&tpl, 2, "ORDER-00000000042", 17));
+  mu_assert("error: template: seqnum wider than the slot", !ff_template_set_uint(&tpl, 0, 1234567));
+  mu_assert("error: template: slot out of range accepted", !ff_template_set(&tpl, tpl.slot_count, "B", 1) && !ff_template_set_uint(&tpl, tpl.slot_count, 1));
+
+  const ff_slot_def_t missing[1] = { { .tag = 44, .width = 8, .variable = true } };
+  mu_assert("error: template: missing slot tag accepted", !ff_template_create(&tpl, buffer, sizeof(buffer), &message, missing, 1));
+  const ff_slot_def_t fixed_clordid[1] = { { .tag = 49, .width = 8, .variable = false } };
+  mu_assert("error: template: padded a non numeric value", !ff_template_create(&tpl, buffer, sizeof(buffer), &message, fixed_clordid, 1));
+  mu_assert("error: template: small buffer accepted", !ff_template_create(&tpl, buffer, 64, &message, defs, 3));
+
+  return 0;
+}
+
+static const uint32_t leg_id_members[] = { 605 };
+static const ff_group_def_t leg_subgroups[] = {
+  { .count_tag = 604, .delimiter_tag = 605, .member_tags = leg_id_members, .member_count = 1 }
+};
+static const uint32_t leg_members[] = { 600, 623 };
+static const uint32_t md_members[] = { 269, 270, 271 };
+static const ff_group_def_t group_defs[] = {
+  { .count_tag = 268, .delimiter_tag = 269, .member_tags = md_members, .member_count = 3 },
+  { .count_tag = 555, .delimiter_tag = 600, .member_tags = leg_members, .member_count = 2, .subgroups = leg_subgroups, .subgroup_count = 1 }
+};
+
+static char *test_get_groups(void)
+{
+  char buffer[] =
+    "8=FIX.4.4\x01"
+    "9=103\x01"
+    "35=W\x01"
+    "268=2\x01"
+    "269=0\x01""270=1.5\x01""271=100\x01"
+    "269=1\x01""270=1.6\x01"
+    "555=2\x01"
+    "600=A\x01""604=2\x01""605=X\x01""605=Y\x01""623=1\x01"
+    "600=B\x01""623=2\x01"
+    "58=done\x01"
+    "10=165\x01";
+
+  fix_field_t fields[32];
+  fix_message_t message = { fields, 32, NULL, FF_PARSE_TAGS };
+  mu_assert("error: get groups: deserialize failed", ff_deserialize(buffer, STR_LEN(buffer), &message) == STR_LEN(buffer));
+
+  ff_group_t group_array[4];
+  uint16_t entries[8];
+  ff_groups_t groups = { group_array, entries, 4, 8, 0, 0 };
+
+  mu_assert("error: get groups: failed", ff_get_groups(&message, group_defs, 2, &groups));
+  mu_assert("error: get groups: wrong group count", groups.group_count == 3 && groups.entry_count == 6);
+
+  const ff_group_t *md = &group_array[0];
+  mu_assert("error: get groups: md entries", md->count_tag == 268 && md->start == 2 && md->end == 7 && md->entry_count == 2);
+  mu_assert("error: get groups: md offsets", entries[md->first_entry] == 2 && entries[md->first_entry + 1] == 5);
+
+  const ff_group_t *legs = &group_array[1];
+  mu_assert("error: get groups: legs", legs->count_tag == 555 && legs->start == 8 && legs->end == 15 && legs->parent == FF_GROUP_NO_PARENT);
+  mu_assert("error: get groups: legs offsets", entries[legs->first_entry] == 8 && entries[legs->first_entry + 1] == 13);
+
+  const ff_group_t *ids = &group_array[2];
+  mu_assert("error: get groups: nested", ids->count_tag == 604 && ids->parent == 1 && ids->parent_entry == 0 && ids->start == 10 && ids->end == 12);
+
+  fields[1].value = "3";
+  message.flags = 0;
+  mu_assert("error: get groups: wrong count accepted", !ff_get_groups(&message, group_defs, 2, &groups));
+
+  return 0;
+}
+
+static char *test_serialize_groups(void)
+{
+  fix_field_t header[1] = {
+    { .tag = "35", .value = "W", .tag_len = 2, .value_len = 1 }
+  };
+  fix_field_t entry_fields[2][2] = {
+    {
+      { .tag = "269", .value = "0", .tag_len = 3, .value_len = 1 },
+      { .tag = "270", .value = "1.5", .tag_len = 3, .value_len = 3 }
+    },
+    {
+      { .tag = "269", .value = "1", .tag_len = 3, .value_len = 1 },
+      { .tag = "270", .value = "1.6", .tag_len = 3, .value_len = 3 }
+    }
+  };
+  fix_field_t leg_fields[1] = {
+    { .tag = "600", .value = "A", .tag_len = 3, .value_len = 1 }
+  };
+  fix_field_t leg_id_fields[2][1] = {
+    { { .tag = "605", .value = "X", .tag_len = 3, .value_len = 1 } },
+    { { .tag = "605", .value = "Y", .tag_len = 3, .value_len = 1 } }
+  };
+
+  const ff_entry_data_t md_entries[2] = {
+    { .fields = entry_fields[0], .field_count = 2 },
+    { .fields = entry_fields[1], .field_count = 2 }
+  };
+  const ff_entry_data_t leg_id_entries[2] = {
+    { .fields = leg_id_fields[0], .field_count = 1 },
+    { .fields = leg_id_fields[1], .field_count = 1 }
+  };
+  const ff_group_data_t leg_ids = { .count_tag = 604, .entry_count = 2, .entries = leg_id_entries };
+  const ff_entry_data_t leg_entries[1] = {
+    { .fields = leg_fields, .field_count = 1, .groups = &leg_ids, .group_count = 1 }
+  };
+  const ff_group_data_t data[2] = {
+    { .count_tag = 268, .entry_count = 2, .entries = md_entries },
+    { .count_tag = 555, .entry_count = 1, .entries = leg_entries }
+  };
+
+  fix_field_t flat[13] = {
+    header[0],
+    { .tag = "268", .value = "2", .tag_len = 3, .value_len = 1 },
+    entry_fields[0][0], entry_fields[0][1], entry_fields[1][0], entry_fields[1][1],
+    { .tag = "555", .value = "1", .tag_len = 3, .value_len = 1 },
+    leg_fields[0],
+    { .tag = "604", .value = "2", .tag_len = 3, .value_len = 1 },
+    leg_id_fields[0][0], leg_id_fields[1][0]
+  };
+  const fix_message_t flat_message = { .fields = flat, .field_count = 11 };
+  const fix_message_t message = { .fields = header, .field_count = 1 };
+
+  char expected_buffer[256];
+  const uint16_t expected_len = ff_serialize(expected_buffer, &flat_message);
+
+  char buffer[256];
+  uint16_t len;
+  const char *start = ff_serialize_groups(buffer, &message, data, 2, &len);
+
+  mu_assert("error: serialize groups: wrong length", len == expected_len);
+  mu_assert("error: serialize groups: wrong buffer", memcmp(start, expected_buffer, len) == 0);
+
+  return 0;
+}
+
+static uint32_t resolve_symbol(void *context, const char *symbol, const uint16_t symbol_len)
+{
+  (void)context;
+  return (symbol_len == 6 && memcmp(symbol, "EURUSD", 6) == 0) ? 1 : 2;
+}
+
+static char *test_decode_md_incremental(void)
+{
+  char buffer[] =
+    "8=FIX.4.4\x01"
+    "9=166\x01"
+    "35=X\x01"
+    "34=7\x01"
+    "268=3\x01"
+    "279=0\x01"
+    "269=0\x01"
+    "55=EURUSD\x01"
+    "270=1.08215\x01"
+    "271=1000000\x01"
+    "273=14:30:01.250\x01"
+    "279=1\x01"
+    "269=1\x01"
+    "270=1.0822\x01"
+    "271=500000\x01"
+    "279=2\x01"
+    "269=0\x01"
+    "55=GBPUSD\x01"
+    "270=1.2701\x01"
+    "273=14:30:01.250123\x01"
+    "10=218\x01";
+
+  char actions[4];
+  char types[4];
+  uint32_t symbols[4];
+  int64_t prices[4];
+  int64_t sizes[4];
+  int64_t times[4];
+  ff_md_columns_t columns = {
+    .actions = actions,
+    .types = types,
+    .symbols = symbols,
+    .prices = prices,
+    .sizes = sizes,
+    .times = times,
+    .capacity = 4,
+    .count = 0,
+    .price_scale = 5,
+    .resolve_symbol = resolve_symbol,
+    .resolver_context = NULL
+  };
+
+  char copy[sizeof(buffer)];
+  memcpy(copy, buffer, sizeof(buffer));
+
+  mu_assert("error: decode md: failed", ff_decode_md_incremental(buffer, STR_LEN(buffer), &columns) == STR_LEN(buffer));
+  mu_assert("error: decode md: wrong count", columns.count == 3);
+  mu_assert("error: decode md: actions", memcmp(actions, "012", 3) == 0 && memcmp(types, "010", 3) == 0);
+  mu_assert("error: decode md: symbols", symbols[0] == 1 && symbols[1] == 1 && symbols[2] == 2);
+  mu_assert("error: decode md: prices", prices[0] == 108215 && prices[1] == 108220 && prices[2] == 127010);
+  mu_assert("error: decode md: sizes", sizes[0] == 1000000 && sizes[1] == 500000 && sizes[2] == 0);
+  mu_assert("error: decode md: times", times[0] == 52201250000000LL && times[1] == 0 && times[2] == 52201250123000LL);
+
+  columns.capacity = 2;
+  memcpy(buffer, copy, sizeof(buffer));
+  mu_assert("error: decode md: capacity exceeded", ff_decode_md_incremental(buffer, STR_LEN(buffer), &columns) == 0);
+
+  columns.capacity = 4;
+  memcpy(buffer, copy, sizeof(buffer));
+  //the changes below keep the checksum valid
+  memcpy(strstr(buffer, "268=3"), "268=2", 5);
+  memcpy(strstr(buffer, "34=7"), "34=8", 4);
+  mu_assert("error: decode md: wrong count accepted", ff_decode_md_incremental(buffer, STR_LEN(buffer), &columns) == 0);
+
+  memcpy(buffer, copy, sizeof(buffer));
+  memcpy(strstr(buffer, "35=X"), "35=W", 4);
+  memcpy(strstr(buffer, "34=7"), "34=8", 4);
+  mu_assert("error: decode md: wrong message type accepted", ff_decode_md_incremental(buffer, STR_LEN(buffer), &columns) == 0);
+
+  return 0;
+}
+
+//enough fields to go through the vector loops of the compact body length
+static char *test_compact_round_trip(void)
+{
+  static const char *const tags[] = { "35", "49", "56", "34", "52", "11", "55", "54", "38", "40", "44", "59", "108", "9999" };
+  char values[40][48];
+  fix_field_t fields[40];
+
+  for (uint8_t i = 0; i < ARR_SIZE(fields); i++)
+  {
+    const char *tag = tags[i % ARR_SIZE(tags)];
+    const uint8_t value_len = 1 + (i * 5) % 47;
+    memset(values[i], 'a' + i % 26, value_len);
+    fields[i] = (fix_field_t){ .tag = (char *)tag, .value = values[i], .tag_len = strlen(tag), .value_len = value_len };
+  }
+  const fix_message_t message = { .fields = fields, .field_count = ARR_SIZE(fields) };
+
+  char expected_buffer[2048];
+  const uint16_t expected_len = ff_serialize(expected_buffer, &message);
+
+  char buffer[2048];
+  memcpy(buffer, expected_buffer, expected_len);
+
+  uint16_t tag_offsets[64];
+  uint16_t value_offsets[64];
+  uint16_t value_lens[64];
+  fix_compact_message_t compact = { NULL, tag_offsets, value_offsets, value_lens, 64 };
+
+  mu_assert("error: compact round trip: wrong length", ff_deserialize_compact(buffer, expected_len, &compact) == expected_len);
+  mu_assert("error: compact round trip: wrong field count", compact.field_count == ARR_SIZE(fields));
+  mu_assert("error: compact round trip: buffer modified", memcmp(buffer, expected_buffer, expected_len) == 0);
+
+  for (uint8_t i = 0; i < ARR_SIZE(fields); i++)
+  {
+    mu_assert("error: compact round trip: wrong tag", memcmp(buffer + tag_offsets[i], fields[i].tag, fields[i].tag_len) == 0);
+    mu_assert("error: compact round trip: wrong tag length", value_offsets[i] - tag_offsets[i] == fields[i].tag_len + 1);
+    mu_assert("error: compact round trip: wrong value", value_lens[i] == fields[i].value_len && memcmp(buffer + value_offsets[i], fields[i].value, value_lens[i]) == 0);
+  }
+
+  char output[2048];
+  mu_assert("error: compact round trip: wrong serialized length", ff_serialize_compact(output, &compact) == expected_len);
+  mu_assert("error: compact round trip: wrong serialized buffer", memcmp(output, expected_buffer, expected_len) == 0);
+
+  compact.field_count = ARR_SIZE(fields) - 1;
+  mu_assert("error: compact round trip: too many fields accepted", ff_deserialize_compact(buffer, expected_len, &compact) == 0);
+
+  return 0;
+}
+
+//the message lives in a read-only page, any write to it would fault
+static char *test_deserialize_const(void)
+{
+  static const char message_str[] =
+    "8=FIX.4.4\x01"
+    "9=73\x01"
+    "6=123\x01"
+    "35=D\x01"
+    "49=BROKER\x01"
+    "56=CLIENT\x01"
+    "34=1\x01"
+    "52=20250210-18:52:11.000\x01"
+    "98=0\x01"
+    "108=30\x01"
+    "10=127\x01";
+  fix_field_t expected_fields[8] = {
+    { .tag = "6", .value = "123", .tag_len = 1, .value_len = 3 },
+    { .tag = "35", .value = "D", .tag_len = 2, .value_len = 1 },
+    { .tag = "49", .value = "BROKER", .tag_len = 2, .value_len = 6 },
+    { .tag = "56", .value = "CLIENT", .tag_len = 2, .value_len = 6 },
+    { .tag = "34", .value = "1", .tag_len = 2, .value_len = 1 },
+    { .tag = "52", .value = "20250210-18:52:11.000", .tag_len = 2, .value_len = 21 },
+    { .tag = "98", .value = "0", .tag_len = 2, .value_len = 1 },
+    { .tag = "108", .value = "30", .tag_len = 3, .value_len = 2 }
+  };
+  const fix_message_t expected_message = { .fields = expected_fields, .field_count = 8 };
+
+  const uint16_t page_size = sysconf(_SC_PAGESIZE);
+  char *page = mmap(NULL, page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  mu_assert("error: deserialize const: mmap failed", page != MAP_FAILED);
+
+  //the second copy has a wrong checksum
+  char *const valid = page;
+  char *const corrupted = page + 256;
+  memcpy(valid, message_str, sizeof(message_str));
+  memcpy(corrupted, message_str, sizeof(message_str));
+  memcpy(corrupted + STR_LEN(message_str) - STR_LEN("127\x01"), "128", 3);
+  mprotect(page, page_size, PROT_READ);
+
+  static fix_tag_index_t index = {0};
+  fix_field_t fields[ARR_SIZE(expected_fields)];
+  fix_message_t message = { fields, ARR_SIZE(fields), &index, FF_PARSE_TAGS };
+
+  const uint16_t len = ff_deserialize_const(valid, sizeof(message_str), &message);
+  mu_assert("error: deserialize const: wrong length", len == STR_LEN(message_str));
+  mu_assert("error: deserialize const: wrong message", compare_messages(&message, &expected_message));
+  mu_assert("error: deserialize const: flags not restored", message.flags == FF_PARSE_TAGS);
+  mu_assert("error: deserialize const: delimiters overwritten", memcmp(valid, message_str, sizeof(message_str)) == 0);
+
+  const fix_field_t *msg_type = ff_get_field(&message, 35);
+  mu_assert("error: deserialize const: lookup failed", msg_type && msg_type->value_len == 1 && msg_type->value[0] == 'D' && msg_type->value[1] == '\x01');
+
+  message.field_count = ARR_SIZE(fields);
+  mu_assert("error: deserialize const: checksum mismatch accepted", ff_deserialize_const(corrupted, sizeof(message_str), &message) == 0);
+
+  munmap(page, page_size);
+  return 0;
+}
+
+//reads one message from fd, the socket is drained by the previous calls so it is never split
+static ff_session_event_t session_receive(ff_session_t *restrict session, fix_message_t *restrict message, char *restrict buffer)
+{
+  const ssize_t len = recv(session->fd, buffer, 512, 0);
+  if (len <= 0)
+    return FF_SESSION_EVENT_ERROR;
+
+  message->field_count = 16;
+  if (ff_deserialize(buffer, len, message) != len)
+    return FF_SESSION_EVENT_ERROR;
+
+  return ff_session_on_message(session, message);
+}
+
+static char *test_session(void)
+{
+  int32_t fds[2];
+  mu_assert("error: session: socketpair failed", socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  const ff_session_config_t initiator_config = { .sender_comp_id = "CLIENT", .target_comp_id = "BROKER", .heartbeat_interval = 30 };
+  const ff_session_config_t acceptor_config = { .sender_comp_id = "BROKER", .target_comp_id = "CLIENT", .heartbeat_interval = 30 };
+
+  static ff_session_t initiator;
+  static ff_session_t acceptor;
+  mu_assert("error: session: create failed", ff_session_create(&initiator, fds[0], &initiator_config) && ff_session_create(&acceptor, fds[1], &acceptor_config));
+
+  char buffer[512] __attribute__((aligned(64)));
+  fix_field_t fields[16];
+  fix_message_t message = { fields, 16, NULL, FF_PARSE_TAGS };
+
+  mu_assert("error: session: logon failed", ff_session_logon(&initiator));
+  mu_assert("error: session: logon not received", session_receive(&acceptor, &message, buffer) == FF_SESSION_EVENT_LOGON);
+  mu_assert("error: session: logon not answered", session_receive(&initiator, &message, buffer) == FF_SESSION_EVENT_LOGON);
+  mu_assert("error: session: not active", initiator.state == FF_SESSION_ACTIVE && acceptor.state == FF_SESSION_ACTIVE);
+
+  fix_field_t order_fields[5] = {
+    { .tag = "35", .value = "D", .tag_len = 2, .value_len = 1 },
+    { .tag = "34", .value = "1", .tag_len = 2, .value_len = 1 },
+    { .tag = "52", .value = "", .tag_len = 2, .value_len = 0 },
+    { .tag = "11", .value = "ORDER1", .tag_len = 2, .value_len = 6 },
+    { .tag = "55", .value = "EURUSD", .tag_len = 2, .value_len = 6 }
+  };
+  const fix_message_t order = { .fields = order_fields, .field_count = 5 };
+  const ff_slot_def_t defs[2] = {
+    { .tag = 34, .width = 10, .variable = true },
+    { .tag = 52, .width = 21, .variable = false }
+  };
+  ff_template_t tpl;
+  char tpl_buffer[256];
+  mu_assert("error: session: template failed", ff_template_create(&tpl, tpl_buffer, sizeof(tpl_buffer), &order, defs, 2));
+
+  mu_assert("error: session: send failed", ff_session_send(&initiator, &tpl));
+  mu_assert("error: session: app message not delivered", session_receive(&acceptor, &message, buffer) == FF_SESSION_EVENT_APP);
+  mu_assert("error: session: wrong app message", memcmp(ff_get_field(&message, 34)->value, "2", 2) == 0);
+
+  //two lost messages: a ResendRequest is answered with a SequenceReset-GapFill
+  initiator.next_outbound += 2;
+  mu_assert("error: session: send failed", ff_session_send(&initiator, &tpl));
+  mu_assert("error: session: gap not detected", session_receive(&acceptor, &message, buffer) == FF_SESSION_EVENT_GAP);
+  mu_assert("error: session: resend request not handled", session_receive(&initiator, &message, buffer) == FF_SESSION_EVENT_NONE);
+  mu_assert("error: session: gap fill not handled", session_receive(&acceptor, &message, buffer) == FF_SESSION_EVENT_NONE);
+  mu_assert("error: session: gap fill without OrigSendingTime", ff_get_field(&message, 122) && ff_get_field(&message, 122)->value_len == 21);
+  mu_assert("error: session: wrong inbound sequence", acceptor.next_inbound == initiator.next_outbound);
+
+  //after the gap fill the sequence numbers are in sync again
+  mu_assert("error: session: send failed", ff_session_send(&initiator, &tpl));
+  mu_assert("error: session: app message not delivered", session_receive(&acceptor, &message, buffer) == FF_SESSION_EVENT_APP);
+
+  //silence from the initiator triggers a TestRequest, answered with a Heartbeat
+  acceptor.last_received -= 40LL * 1000000000LL;
+  mu_assert("error: session: poll failed", ff_session_poll(&acceptor) == FF_SESSION_EVENT_NONE && acceptor.test_request_pending);
+  mu_assert("error: session: test request not handled", session_receive(&initiator, &message, buffer) == FF_SESSION_EVENT_NONE);
+  mu_assert("error: session: heartbeat not handled", session_receive(&acceptor, &message, buffer) == FF_SESSION_EVENT_NONE);
+  mu_assert("error: session: test request still pending", !acceptor.test_request_pending);
+
+  //without a heartbeat interval the timers never fire
+  acceptor.heartbeat_interval = 0;
+  acceptor.last_received -= 40LL * 1000000000LL;
+  mu_assert("error: session: timers not disabled", ff_session_poll(&acceptor) == FF_SESSION_EVENT_NONE && !acceptor.test_request_pending);
+
+  mu_assert("error: session: logout failed", ff_session_logout(&initiator));
+  mu_assert("error: session: logout not received", session_receive(&acceptor, &message, buffer) == FF_SESSION_EVENT_LOGOUT);
+  mu_assert("error: session: logout not answered", session_receive(&initiator, &message, buffer) == FF_SESSION_EVENT_LOGOUT);
+  mu_assert("error: session: not closed", initiator.state == FF_SESSION_CLOSED && acceptor.state == FF_SESSION_CLOSED);
+
+  close(fds[0]);
+  close(fds[1]);
+  return 0;
+}
+
+static bool tcp_loopback_pair(int32_t *restrict client, int32_t *restrict server)
+{
+  const int32_t listener = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = 0, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+  socklen_t addr_len = sizeof(addr);
+
+  bool connected = listener >= 0;
+  connected = connected && bind(listener, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+  connected = connected && listen(listener, 1) == 0;
+  connected = connected && getsockname(listener, (struct sockaddr *)&addr, &addr_len) == 0;
+  connected = connected && (*client = socket(AF_INET, SOCK_STREAM, 0)) >= 0;
+  connected = connected && connect(*client, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+  connected = connected && (*server = accept(listener, NULL, NULL)) >= 0;
+
+  if (listener >= 0)
+    close(listener);
+  return connected;
+}
+
+//buffers smaller than two messages, so most of them are split and go through the carry buffer
+static char *uring_receive_messages(const ff_uring_config_t *config)
+{
+  static const char message_str[] =
+    "8=FIX.4.4\x01"
+    "9=73\x01"
+    "6=123\x01"
+    "35=D\x01"
+    "49=BROKER\x01"
+    "56=CLIENT\x01"
+    "34=1\x01"
+    "52=20250210-18:52:11.000\x01"
+    "98=0\x01"
+    "108=30\x01"
+    "10=127\x01";
+  constexpr uint16_t n_messages = 40;
+
+  int32_t client;
+  int32_t server;
+  mu_assert("error: uring: loopback connection failed", tcp_loopback_pair(&client, &server));
+
+  static ff_uring_t uring;
+  if (!ff_uring_create(&uring, server, config))
+  {
+    //io_uring can be disabled by the kernel or a seccomp filter
+    close(client);
+    close(server);
+    return 0;
+  }
+
+  char stream[n_messages * STR_LEN(message_str) + 16];
+  for (uint16_t i = 0; i < n_messages; i++)
+    memcpy(stream + i * STR_LEN(message_str), message_str, STR_LEN(message_str));
+  //garbage between two messages is skipped, even when it looks like a header
+  memmove(stream + STR_LEN(message_str) + 16, stream + STR_LEN(message_str), (n_messages - 1) * STR_LEN(message_str));
+  memcpy(stream + STR_LEN(message_str), "8=FIX.4.4\x01""9=99\x01x", 16);
+
+  uint32_t sent = 0;
+  uint16_t received = 0;
+  uint16_t rejected = 0;
+  fix_field_t fields[4][16];
+  fix_message_t messages[4];
+
+  for (uint32_t spins = 0; received + (rejected > 0) < n_messages && spins < 100000000; spins++)
+  {
+    if (sent < sizeof(stream))
+    {
+      const uint32_t chunk = (sizeof(stream) - sent < 97) ? sizeof(stream) - sent : 97;
+      sent += send(client, stream + sent, chunk, 0);
+    }
+
+    //now and then the messages don't fit: the first one is skipped, the others are received again with more fields
+    for (uint8_t i = 0; i < 4; i++)
+      messages[i] = (fix_message_t){ .fields = fields[i], .field_count = (spins % 5) ? 16 : 7 };
+
+    int32_t buffer_id;
+    const uint16_t count = ff_uring_receive(&uring, messages, 4, &buffer_id);
+    for (uint16_t i = 0; i < count; i++)
+      mu_assert("error: uring: wrong message", messages[i].field_count == 8 && memcmp(messages[i].fields[1].value, "D", 2) == 0);
+
+    if (uring.rejected)
+    {
+      mu_assert("error: uring: wrong rejected length", uring.rejected == STR_LEN(message_str));
+      if (!rejected)
+        ff_uring_skip(&uring);
+      rejected++;
+    }
+
+    received += count;
+    ff_uring_release(&uring, buffer_id);
+  }
+  mu_assert("error: uring: wrong number of messages", received == n_messages - 1 && rejected > 0);
+
+  close(client);
+  int32_t buffer_id;
+  for (uint32_t spins = 0; !uring.closed && spins < 100000000; spins++)
+    ff_uring_receive(&uring, messages, 4, &buffer_id);
+  mu_assert("error: uring: close not detected", uring.closed);
+
+  ff_uring_destroy(&uring);
+  close(server);
+  return 0;
+}
+
+static char *test_uring_receive(void)
+{
+  const ff_uring_config_t configs[] = {
+    { .buffer_count = 4, .buffer_size = 128, .sqpoll = false, .busy_poll = false },
+    { .buffer_count = 4, .buffer_size = 128, .sqpoll = true, .busy_poll = true }
+  };
+
+  for (uint8_t i = 0; i < ARR_SIZE(configs); i++)
+  {
+    char *const message = uring_receive_messages(&configs[i]);
+    if (message)
+      return message;
+  }
+
+  return 0;
+}
+
+//three segments worth of messages through two segments, so a segment is reused after its zerocopy completion
+static char *test_batch_send(void)
+{
+  fix_field_t fields[8] = {
+    { .tag = "6", .value = "123", .tag_len = 1, .value_len = 3 },
+    { .tag = "35", .value = "D", .tag_len = 2, .value_len = 1 },
+    { .tag = "49", .value = "BROKER", .tag_len = 2, .value_len = 6 },
+    { .tag = "56", .value = "CLIENT", .tag_len = 2, .value_len = 6 },
+    { .tag = "34", .value = "1", .tag_len = 2, .value_len = 1 },
+    { .tag = "52", .value = "20250210-18:52:11.000", .tag_len = 2, .value_len = 21 },
+    { .tag = "98", .value = "0", .tag_len = 2, .value_len = 1 },
+    { .tag = "108", .value = "30", .tag_len = 3, .value_len = 2 }
+  };
+  const fix_message_t message = { .fields = fields, .field_count = 8 };
+  constexpr uint16_t message_len = 95;
+  constexpr uint16_t n_messages = 14;
+
+  int32_t client;
+  int32_t server;
+  mu_assert("error: batch: loopback connection failed", tcp_loopback_pair(&client, &server));
+
+  static ff_clock_t clock;
+  ff_clock_init(&clock, 3);
+
+  ff_batch_t batch;
+  ff_batch_config_t config = { .clock = &clock, .latency_budget = 1000000000LL, .segment_size = 512, .segment_count = 2, .zerocopy = true };
+  mu_assert("error: batch: create failed", ff_batch_create(&batch, client, &config));
+
+  for (uint16_t i = 0; i < n_messages - 2; i++)
+    mu_assert("error: batch: add failed", ff_batch_add(&batch, &message));
+  mu_assert("error: batch: segments not flushed when full", batch.pending == 2 && batch.len == 2 * message_len);
+  mu_assert("error: batch: flush failed", ff_batch_flush(&batch) && batch.len == 0);
+  ff_batch_destroy(&batch);
+
+  //without budget every message is sent right away, with a budget the event loop flushes it once expired
+  config.latency_budget = 0;
+  mu_assert("error: batch: create failed", ff_batch_create(&batch, client, &config));
+  mu_assert("error: batch: message held back", ff_batch_add(&batch, &message) && batch.len == 0);
+  ff_batch_destroy(&batch);
+
+  config.latency_budget = 1000000;
+  mu_assert("error: batch: create failed", ff_batch_create(&batch, client, &config));
+  mu_assert("error: batch: add failed", ff_batch_add(&batch, &message) && batch.len == message_len);
+  nanosleep(&(struct timespec){ .tv_nsec = 2000000 }, NULL);
+  mu_assert("error: batch: budget not enforced", ff_batch_poll(&batch) && batch.len == 0);
+  ff_batch_destroy(&batch);
+
+  char buffer[n_messages * message_len];
+  uint32_t received = 0;
+  while (received < sizeof(buffer))
+  {
+    const ssize_t len = recv(server, buffer + received, sizeof(buffer) - received, 0);
+    mu_assert("error: batch: recv failed", len > 0);
+    received += len;
+  }
+
+  for (uint16_t i = 0; i < n_messages; i++)
+  {
+    fix_field_t parsed_fields[8];
+    fix_message_t parsed = { .fields = parsed_fields, .field_count = 8 };
+    mu_assert("error: batch: wrong message", ff_deserialize(buffer + i * message_len, message_len, &parsed) == message_len);
+  }
+
+  close(client);
+  close(server);
+  return 0;
+}
+
+static char *test_journal(void)
+{
+  fix_field_t fields[3] = {
+    { .tag = "35", .value = "D", .tag_len = 2, .value_len = 1 },
+    { .tag = "34", .value = "1", .tag_len = 2, .value_len = 1 },
+    { .tag = "98", .value = "0", .tag_len = 2, .value_len = 1 }
+  };
+  const fix_message_t message = { .fields = fields, .field_count = 3 };
+  const char heartbeat[] = "8=FIX.4.4\x01""9=5\x01""35=0\x01""10=161\x01";
+
+  char path[] = "/tmp/flashfix_journal_XXXXXX";
+  const int32_t fd = mkstemp(path);
+  mu_assert("error: journal: temporary file failed", fd >= 0);
+  close(fd);
+
+  ff_journal_t journal;
+  mu_assert("error: journal: open failed", ff_journal_open(&journal, path, 16, 4096));
+
+  char serialized[64];
+  const uint16_t message_len = ff_serialize(serialized, &message);
+  for (uint32_t seq_num = 1; seq_num <= 5; seq_num++)
+    mu_assert("error: journal: append failed", ff_journal_append_message(&journal, seq_num, &message));
+  mu_assert("error: journal: append failed", ff_journal_append(&journal, 8, heartbeat, STR_LEN(heartbeat)));
+  mu_assert("error: journal: lower seq num accepted", !ff_journal_append(&journal, 8, heartbeat, STR_LEN(heartbeat)));
+  mu_assert("error: journal: seq num past capacity accepted", !ff_journal_append(&journal, 17, heartbeat, STR_LEN(heartbeat)));
+  mu_assert("error: journal: sync failed", ff_journal_sync(&journal, true));
+  ff_journal_close(&journal);
+
+  //reopening maps the file as it is, the sizes passed are ignored
+  mu_assert("error: journal: reopen failed", ff_journal_open(&journal, path, 0, 0));
+  mu_assert("error: journal: wrong next seq num", ff_journal_next_seq(&journal) == 9);
+
+  uint64_t len;
+  const char *messages = ff_journal_read(&journal, 2, 4, &len);
+  mu_assert("error: journal: wrong range", messages && len == 3u * message_len);
+  for (uint8_t i = 0; i < 3; i++)
+    mu_assert("error: journal: wrong message", memcmp(messages + i * message_len, serialized, message_len) == 0);
+
+  //skipped sequence numbers take no bytes
+  messages = ff_journal_read(&journal, 5, 0, &len);
+  mu_assert("error: journal: wrong gap", messages && len == message_len + STR_LEN(heartbeat));
+  mu_assert("error: journal: wrong last message", memcmp(messages + message_len, heartbeat, STR_LEN(heartbeat)) == 0);
+  mu_assert("error: journal: read before first seq num", !ff_journal_read(&journal, 0, 2, &len));
+  mu_assert("error: journal: read after last seq num", !ff_journal_read(&journal, 9, 0, &len));
+
+  mu_assert("error: journal: append after reopen failed", ff_journal_append_message(&journal, 9, &message));
+  mu_assert("error: journal: wrong next seq num", ff_journal_next_seq(&journal) == 10);
+
+  //a message that never reached the disk is dropped on reopen, the ones before it are kept
+  mu_assert("error: journal: append failed", ff_journal_append_message(&journal, 10, &message));
+  mu_assert("error: journal: sync failed", ff_journal_sync(&journal, false));
+  memset((char *)ff_journal_read(&journal, 10, 10, &len), 0, len);
+  ff_journal_close(&journal);
+  mu_assert("error: journal: reopen failed", ff_journal_open(&journal, path, 0, 0));
+  mu_assert("error: journal: lost message kept", ff_journal_next_seq(&journal) == 10 && journal.header->durable_count == 8);
+
+  ff_journal_close(&journal);
+  unlink(path);
+  return 0;
+}
+
+typedef struct
+{
+  uint64_t counts[4];
+  const char *last[4];
+  bool ordered;
+} capture_result_t;
+
+static void capture_callback(const fix_message_t *message, const char *raw, const uint16_t len, const uint16_t thread, void *context)
+{
+  capture_result_t *const result = context;
+
+  result->ordered &= (thread < 4) && (raw > result->last[thread]) && (message->field_count == 3) && (raw[len - 1] == '\x01');
+  result->last[thread] = raw;
+  result->counts[thread]++;
+}
+
+static char *test_capture_parse(void)
+{
+  const char message[] = "8=FIX.4.4\x01""9=19\x01""35=D\x01""34=1\x01""58=8=FIX\x01""10=201\x01";
+  const char garbage[] = "8=FIX.4.4\x01""9=7";
+  constexpr uint16_t n_messages = 1000;
+
+  char path[] = "/tmp/flashfix_capture_XXXXXX";
+  const int32_t fd = mkstemp(path);
+  mu_assert("error: capture: temporary file failed", fd >= 0);
+  for (uint16_t i = 0; i < n_messages; i++)
+  {
+    bool written = write(fd, message, STR_LEN(message)) == STR_LEN(message);
+    if (i == n_messages / 3)
+      written &= write(fd, garbage, STR_LEN(garbage)) == STR_LEN(garbage);
+    mu_assert("error: capture: write failed", written);
+  }
+  close(fd);
+
+  ff_capture_t capture;
+  mu_assert("error: capture: open failed", ff_capture_open(&capture, path));
+
+  //chunk edges fall inside messages and on the "8=FIX" in the text field
+  constexpr uint16_t thread_counts[] = { 1, 3, 4 };
+  for (uint8_t i = 0; i < ARR_SIZE(thread_counts); i++)
+  {
+    capture_result_t result = { .ordered = true };
+    uint64_t parsed;
+    mu_assert("error: capture: parse failed", ff_capture_parse(&capture, thread_counts[i], 8, capture_callback, &result, &parsed));
+
+    uint64_t total = 0;
+    for (uint8_t j = 0; j < 4; j++)
+      total += result.counts[j];
+    mu_assert("error: capture: wrong message count", parsed == n_messages && total == n_messages);
+    mu_assert("error: capture: messages out of order", result.ordered);
+    mu_assert("error: capture: thread without messages", result.counts[thread_counts[i] - 1] > 0);
+  }
+
+  //messages with too many fields are reported, not skipped as corrupted
+  capture_result_t result = { .ordered = true };
+  uint64_t parsed;
+  mu_assert("error: capture: too many fields accepted", !ff_capture_parse(&capture, 4, 2, capture_callback, &result, &parsed) && parsed == 0);
+
+  ff_capture_close(&capture);
+  unlink(path);
+  return 0;
+}